@@ -18,10 +18,17 @@
 #
 
 import argparse
+import colorsys
 import cProfile
+import operator
 import os
 import pstats
+import re
 import struct
+import sys
+import zlib
+
+from capturefile import CaptureFile, EXTENSION as CAPTURE_EXTENSION, parse_range
 
 
 def _calculate_shift(mask: int):
@@ -44,6 +51,14 @@ def _shift(color: int, shift: int):
     return color >> shift if shift > 0 else color << -shift
 
 
+# Runs of the same byte are found by regular expression engine instead of comparing pixels one by one
+_RUN = re.compile(rb'(.)\1*', re.DOTALL)
+
+_MIN_RLE_RUN = 3  # shorter runs are stored in absolute mode
+_MAX_RLE_COUNT = 255
+_MAX_RLE_LITERAL = 254  # even, so absolute mode chunks of 4-bit pixels are whole bytes
+
+
 class BMPFile:
     # https://en.wikipedia.org/wiki/BMP_file_format#Bitmap_file_header
     HEADER_FORMAT = '<2sI4xI'
@@ -52,17 +67,26 @@ class BMPFile:
     MAGIC = b'BM'
 
     # https://en.wikipedia.org/wiki/BMP_file_format#DIB_header_(bitmap_information_header)
-    BITMAPINFOHEADER_FORMAT = '3I2H5I4x'
+    BITMAPINFOHEADER_FORMAT = 'I2i2H5I4x'
     BITMAPINFOHEADER_SIZE = 40
 
     BI_RGB = 0
+    BI_RLE8 = 1
+    BI_RLE4 = 2
     BI_BITFIELDS = 3
 
     # https://en.wikipedia.org/wiki/BMP_file_format#Example_2
-    BITMAPV4HEADER_FORMAT = '<3I2H2I2I8x4I52x'
+    BITMAPV4HEADER_FORMAT = '<I2i2H2I2I8x4I52x'
     BITMAPV4HEADER_SIZE = 108
 
-    def __init__(self, filename: str):
+    # https://www.w3.org/TR/png/#5PNG-file-signature
+    PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+    PNG_IHDR_FORMAT = '>2I5B'
+
+    def __init__(self, filename: str = None):
+        if not filename:
+            return
+
         with open(filename, 'rb') as f:
             bmpheader = f.read(BMPFile.HEADER_SIZE)
             magic, _, _ = struct.unpack(BMPFile.HEADER_FORMAT, bmpheader)
@@ -82,26 +106,110 @@ class BMPFile:
             assert compression == BMPFile.BI_BITFIELDS
 
             data = f.read(datasize)
-            pixels = [pixel[0] for pixel in struct.iter_unpack('<H', data)]
+            self._set_pixels(data)
+
+    @staticmethod
+    def from_rgb565(width: int, height: int, data) -> 'BMPFile':
+        """Create bitmap from RGB565 pixels stored from top to bottom, e.g. a frame of capture file"""
+        bmpfile = BMPFile()
+        bmpfile.width = width
+        bmpfile.height = -height  # from top to bottom
+        bmpfile.xres = bmpfile.yres = 3780  # 96 DPI
+        bmpfile.redmask, bmpfile.greenmask, bmpfile.bluemask, bmpfile.alphamask = 0xf800, 0x07e0, 0x001f, 0
+        bmpfile._set_pixels(data)
+
+        return bmpfile
+
+    def _set_pixels(self, data):
+        pixels = [pixel[0] for pixel in struct.iter_unpack('<H', data)]
+
+        palette = {}
+        colorscount = 0
+
+        for pixel in pixels:
+            if pixel not in palette:
+                palette[pixel] = colorscount
+                colorscount += 1
+
+        self.pixels = pixels
+        self.palette = palette
+        self.colorscount = colorscount
+        self.colors = None  # RGB of palette colors after transformations
+
+        self.redshift = _calculate_shift(self.redmask)
+        self.greenshift = _calculate_shift(self.greenmask)
+        self.blueshift = _calculate_shift(self.bluemask)
+
+    def transform(self, function):
+        """Replace every color with result of function, which takes and returns RGB tuple
+
+        Only palette is changed, so cost depends on number of unique colors, not on number of pixels."""
+        self.colors = {color: tuple(function(self._rgb(color))) for color in self.palette}
+
+    def invert_theme(self):
+        """Swap dark and light keeping hue, e.g. for printing of screenshots"""
+        def invert(rgb: tuple) -> tuple:
+            hue, lightness, saturation = colorsys.rgb_to_hls(*(component / 255 for component in rgb))
+            return tuple(round(component * 255) for component in colorsys.hls_to_rgb(hue, 1 - lightness, saturation))
+
+        self.transform(invert)
+
+    def grayscale(self):
+        def gray(rgb: tuple) -> tuple:
+            red, green, blue = rgb
+            luma = round(0.299 * red + 0.587 * green + 0.114 * blue)
+            return luma, luma, luma
+
+        self.transform(gray)
 
-            palette = {}
-            colorscount = 0
+    def remap_colors(self, mapping: dict):
+        """Replace colors given as RGB tuples with other ones
 
-            for pixel in pixels:
-                if pixel not in palette:
-                    palette[pixel] = colorscount
-                    colorscount += 1
+        Colors of pixels have fewer bits, e.g. RGB565, so given colors are reduced to them before lookup.
+        Colors that match none of the pixels are reported."""
+        masks = (0xff, 0xff, 0xff)
 
-            self.pixels = pixels
-            self.palette = palette
-            self.colorscount = colorscount
+        if not self.colors:
+            masks = [0xff << (8 - bin(mask).count('1')) & 0xff for mask in (self.redmask, self.greenmask, self.bluemask)]
 
-            self.redshift = _calculate_shift(self.redmask)
-            self.greenshift = _calculate_shift(self.greenmask)
-            self.blueshift = _calculate_shift(self.bluemask)
+        present = {self._rgb(color) for color in self.palette}
+        reduced = {}
+
+        for rgb, target in mapping.items():
+            key = tuple(map(operator.and_, rgb, masks))
+
+            if key in present:
+                reduced[key] = target
+            else:
+                print(f'Warning: color {bytes(rgb).hex()} not found, remap of it is ignored', file=sys.stderr)
+
+        self.transform(lambda rgb: reduced.get(rgb, rgb))
+
+    def highlight(self, rgb: tuple, distance: int = 32, dim: float = 0.25):
+        """Fade all colors except ones close to given RGB towards background, i.e. color of the first pixel"""
+        background = self._rgb(self.pixels[0])
+
+        def fade(color: tuple) -> tuple:
+            if color == background or max(abs(a - b) for a, b in zip(color, rgb)) <= distance:
+                return color
+
+            return tuple(round(back + (component - back) * dim) for component, back in zip(color, background))
+
+        self.transform(fade)
+
+    def _rgb(self, color: int) -> tuple:
+        if self.colors:
+            return self.colors[color]
+
+        red = _shift(color & self.redmask, self.redshift)
+        green = _shift(color & self.greenmask, self.greenshift)
+        blue = _shift(color & self.bluemask, self.blueshift)
+        return red, green, blue
 
     def save(self, filename: str):
-        if self.colorscount > 256:
+        if filename.lower().endswith('.png'):
+            self._save_png(filename)
+        elif self.colorscount > 256:
             self._save_rgb(filename)
         else:
             self._save_paletted(filename)
@@ -110,13 +218,26 @@ class BMPFile:
         assert self.colorscount <= 256
 
         fourbitpalette = self.colorscount <= 16
-        datasize = len(self.pixels)
-        bpp = 8
+        indices = bytes(map(self.palette.__getitem__, self.pixels))
+        bpp = 4 if fourbitpalette else 8
 
         if fourbitpalette:
-            datasize //= 2
-            bpp //= 2
+            data = bytes(high << 4 | low for high, low in zip(indices[::2], indices[1::2]))
+        else:
+            data = indices
+
+        height = self.height
+        compression = BMPFile.BI_RGB
+
+        # Screens are mostly long runs of background color, use compression when it's smaller
+        rledata = self._encode_rle(indices, fourbitpalette)
+
+        if len(rledata) < len(data):
+            data = rledata
+            height = abs(height)  # compressed bitmap is always stored from bottom to top
+            compression = BMPFile.BI_RLE4 if fourbitpalette else BMPFile.BI_RLE8
 
+        datasize = len(data)
         dataoffset = BMPFile.HEADER_SIZE + BMPFile.BITMAPINFOHEADER_SIZE + self.colorscount * 4
         filesize = dataoffset + datasize
 
@@ -125,24 +246,77 @@ class BMPFile:
             f.write(bmpheader)
 
             dibheader = struct.pack(BMPFile.BITMAPINFOHEADER_FORMAT, BMPFile.BITMAPINFOHEADER_SIZE,
-                self.width, self.height, 1, bpp, BMPFile.BI_RGB, datasize, self.xres, self.yres, self.colorscount)
+                self.width, height, 1, bpp, compression, datasize, self.xres, self.yres, self.colorscount)
             f.write(dibheader)
 
             for color in self.palette:
-                red = _shift(color & self.redmask, self.redshift)
-                green = _shift(color & self.greenmask, self.greenshift)
-                blue = _shift(color & self.bluemask, self.blueshift)
+                red, green, blue = self._rgb(color)
                 entry = struct.pack('4B', blue, green, red, 0)
                 f.write(entry)
 
-            if fourbitpalette:
-                for pixel1, pixel2 in zip(*[iter(self.pixels)] * 2):
-                    pixel = struct.pack('B', (self.palette[pixel1] << 4) + self.palette[pixel2])
-                    f.write(pixel)
+            f.write(data)
+
+    def _encode_rle(self, indices: bytes, fourbit: bool) -> bytes:
+        # https://learn.microsoft.com/en-us/windows/win32/gdi/bitmap-compression
+        width = self.width
+        rows = [indices[offset:offset + width] for offset in range(0, len(indices), width)]
+
+        if self.height < 0:
+            rows.reverse()  # pixels are stored from top to bottom
+
+        encoded = bytearray()
+
+        for row in rows:
+            literal = None  # start of pixels not in runs
+
+            for run in _RUN.finditer(row):
+                start, end = run.span()
+
+                if end - start < _MIN_RLE_RUN:
+                    if literal is None:
+                        literal = start
+
+                    continue
+
+                if literal is not None:
+                    BMPFile._encode_rle_literal(encoded, row[literal:start], fourbit)
+                    literal = None
+
+                value = row[start] * 0x11 if fourbit else row[start]  # both nibbles have the same color
+
+                for offset in range(start, end, _MAX_RLE_COUNT):
+                    encoded += bytes((min(end - offset, _MAX_RLE_COUNT), value))
+
+            if literal is not None:
+                BMPFile._encode_rle_literal(encoded, row[literal:], fourbit)
+
+            encoded += b'\x00\x00'  # end of line
+
+        encoded += b'\x00\x01'  # end of bitmap
+        return bytes(encoded)
+
+    @staticmethod
+    def _encode_rle_literal(encoded: bytearray, pixels: bytes, fourbit: bool):
+        for offset in range(0, len(pixels), _MAX_RLE_LITERAL):
+            chunk = pixels[offset:offset + _MAX_RLE_LITERAL]
+
+            if len(chunk) < 3:
+                # Absolute mode needs at least three pixels, store them as runs of one pixel
+                for value in chunk:
+                    encoded += bytes((1, value * 0x11 if fourbit else value))
+
+                continue
+
+            if fourbit:
+                data = bytes(high << 4 | low for high, low in zip(chunk[::2], chunk[1::2] + b'\x00'))
             else:
-                for pixel in self.pixels:
-                    pixel = struct.pack('B', self.palette[pixel])
-                    f.write(pixel)
+                data = chunk
+
+            encoded += bytes((0, len(chunk)))
+            encoded += data
+
+            if len(data) % 2:
+                encoded += b'\x00'  # absolute mode data is aligned to 16 bits
 
     def _save_rgb(self, filename: str):
         datasize = len(self.pixels) * 3  # 24bit per pixel
@@ -157,39 +331,120 @@ class BMPFile:
                 self.width, self.height, 1, 24, BMPFile.BI_RGB, datasize, self.xres, self.yres, 0)
             f.write(dibheader)
 
-            for color in self.pixels:
-                red = _shift(color & self.redmask, self.redshift)
-                green = _shift(color & self.greenmask, self.greenshift)
-                blue = _shift(color & self.bluemask, self.blueshift)
-                pixel = struct.pack('3B', blue, green, red)
-                f.write(pixel)
+            # Convert every unique color once, pixels are looked up
+            bgr = {color: bytes(reversed(self._rgb(color))) for color in self.palette}
+            f.write(b''.join(map(bgr.__getitem__, self.pixels)))
+
+    def _save_png(self, filename: str):
+        # https://www.w3.org/TR/png/#5Chunk-layout
+        def chunk(kind: bytes, data: bytes) -> bytes:
+            return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data))
+
+        paletted = self.colorscount <= 256
+        height = abs(self.height)
+
+        if paletted:
+            colortype = 3
+            stride = self.width
+            pixels = bytes(self.palette[pixel] for pixel in self.pixels)
+        else:
+            colortype = 2
+            stride = self.width * 3
+            rgb = {color: bytes(self._rgb(color)) for color in self.palette}
+            pixels = b''.join(map(rgb.__getitem__, self.pixels))
 
+        rows = [pixels[offset:offset + stride] for offset in range(0, height * stride, stride)]
 
-def convert(filename: str, inplace: bool = False):
+        if self.height > 0:
+            rows.reverse()  # bitmap is stored from bottom to top
+
+        # Each row starts with filter type, zero means no filtering
+        image = b''.join(b'\x00' + row for row in rows)
+
+        with open(filename, 'wb') as f:
+            f.write(BMPFile.PNG_SIGNATURE)
+            f.write(chunk(b'IHDR', struct.pack(BMPFile.PNG_IHDR_FORMAT, self.width, height, 8, colortype, 0, 0, 0)))
+
+            if paletted:
+                f.write(chunk(b'PLTE', bytes(component for color in self.palette for component in self._rgb(color))))
+
+            f.write(chunk(b'IDAT', zlib.compress(image)))
+            f.write(chunk(b'IEND', b''))
+
+
+def _parse_rgb(text: str) -> tuple:
+    """Convert RRGGBB hex text to RGB tuple"""
+    value = int(text.lstrip('#'), 16)
+    return value >> 16, (value >> 8) & 0xff, value & 0xff
+
+
+def _apply(bmpfile: BMPFile, operations: list):
+    for operation, argument in operations or ():
+        if operation == 'remap':
+            bmpfile.remap_colors({_parse_rgb(source): _parse_rgb(target)
+                                  for source, target in (pair.split(':') for pair in argument)})
+        elif operation == 'invert':
+            bmpfile.invert_theme()
+        elif operation == 'grayscale':
+            bmpfile.grayscale()
+        elif operation == 'highlight':
+            bmpfile.highlight(_parse_rgb(argument))
+
+
+def convert(filename: str, inplace: bool = False, extension: str = None, operations: list = None):
     bmpfile = BMPFile(filename)
+    _apply(bmpfile, operations)
+    path, source_extension = os.path.splitext(filename)
 
     if not inplace:
-        path, extension = os.path.splitext(filename)
-        filename = path + '_converted' + extension
+        path += '_converted'
+
+    bmpfile.save(path + (extension or source_extension))
+
+    if inplace and extension and extension != source_extension:
+        os.remove(filename)
+
 
-    bmpfile.save(filename)
+def export(filename: str, frames: str = None, extension: str = None, operations: list = None):
+    path = os.path.splitext(filename)[0]
+
+    with CaptureFile(filename) as capture:
+        for index in parse_range(frames, len(capture)):
+            bmpfile = BMPFile.from_rgb565(capture.width, capture.height, capture.pixels(index))
+            _apply(bmpfile, operations)
+            bmpfile.save(f'{path}_{index:05}{extension or ".bmp"}')
 
 
 def main():
     parser = argparse.ArgumentParser()
-    parser.add_argument('files', metavar='bmp-file', type=str, nargs='+')
+    parser.add_argument('files', metavar='bmp-or-cap-file', type=str, nargs='+')
     parser.add_argument('--profile', action='store_true', help='enable profiling')
     parser.add_argument('--inplace', action='store_true', help='replace source files with converted')
+    parser.add_argument('--format', choices=('bmp', 'png'), help='save in given format instead of source one')
+    parser.add_argument('--frames', help='export given frames of capture files only, N, N-M, N- or -M', metavar='range')
+    parser.add_argument('--remap', nargs='+', metavar='RRGGBB:RRGGBB', help='replace colors')
+    parser.add_argument('--invert', action='store_true', help='swap dark and light colors keeping their hue')
+    parser.add_argument('--grayscale', action='store_true', help='convert colors to shades of gray')
+    parser.add_argument('--highlight', metavar='RRGGBB', help='fade all colors except given one, e.g. of a trace')
     args = parser.parse_args()
 
+    # Color transformations in fixed order, each one applies to result of previous
+    operations = [(operation, getattr(args, operation)) for operation in ('remap', 'invert', 'grayscale', 'highlight')
+                  if getattr(args, operation)]
+
     profiler = None
 
     if args.profile:
         profiler = cProfile.Profile()
         profiler.enable()
 
+    extension = f'.{args.format}' if args.format else None
+
     for filename in args.files:
-        convert(filename, args.inplace)
+        if filename.endswith(CAPTURE_EXTENSION):
+            export(filename, args.frames, extension, operations)
+        else:
+            convert(filename, args.inplace, extension, operations)
 
     if profiler:
         profiler.disable()
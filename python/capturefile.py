@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Container for many screen captures of the same size
+#
+# File layout, all values are little endian:
+#   header: magic, version, width, height, pixel format
+#   frames: timestamp, flags, data size, raw or zlib compressed RGB565 pixels, top to bottom
+#   index: offset, timestamp, flags and data size of every frame
+#   footer: offset of index, number of frames, index magic
+#
+# Index is written when file is closed. If it's missing, e.g. after a crash, frames are found by scanning the file
+# up to the first invalid frame header.
+
+import argparse
+import datetime
+import mmap
+import os
+import struct
+import time
+import zlib
+
+
+EXTENSION = '.cap'
+
+
+class _Formats:
+    HEADER = '<6s3HI'
+    FRAME = '<d2I'
+    INDEX_ENTRY = '<Qd2I'
+    FOOTER = '<QI4s'
+
+
+_HEADER_SIZE = struct.calcsize(_Formats.HEADER)
+_FRAME_SIZE = struct.calcsize(_Formats.FRAME)
+_INDEX_ENTRY_SIZE = struct.calcsize(_Formats.INDEX_ENTRY)
+_FOOTER_SIZE = struct.calcsize(_Formats.FOOTER)
+
+
+class Frame:
+    def __init__(self, offset: int, timestamp: float, flags: int, size: int):
+        self.offset = offset  # of frame data, i.e. after frame header
+        self.timestamp = timestamp
+        self.flags = flags
+        self.size = size
+
+
+class CaptureFile:
+    MAGIC = b'A6RCAP'
+    INDEX_MAGIC = b'A6RI'
+    VERSION = 1
+
+    FORMAT_RGB565 = 0
+
+    FLAG_ZLIB = 1
+
+    def __init__(self, path: str, width: int = 0, height: int = 0, compress: bool = False):
+        """Open existing container for reading or appending, create new one if width and height are given"""
+        self.path = path
+        self.compress = compress
+        self.frames = []
+        self._mmap = None
+        self._end = _HEADER_SIZE  # of frame data
+        self._dirty = False
+
+        exists = os.path.exists(path) and os.path.getsize(path) > 0
+
+        if not exists and not (width and height):
+            raise FileNotFoundError(f'No capture file {path}')
+
+        self._file = open(path, 'r+b' if exists else 'w+b')
+
+        if exists:
+            try:
+                self._load()
+
+                if width and height and (width, height) != (self.width, self.height):
+                    raise RuntimeError(f'Cannot append {width}x{height} frames to {self.width}x{self.height} capture file {path}')
+            except Exception:
+                self._unmap()
+                self._file.close()
+                self._file = None
+                raise
+        else:
+            self.width, self.height = width, height
+            self._file.write(struct.pack(_Formats.HEADER, self.MAGIC, self.VERSION, width, height, self.FORMAT_RGB565))
+            self._dirty = True
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __len__(self):
+        return len(self.frames)
+
+    def close(self):
+        if not self._file:
+            return
+
+        self._unmap()
+
+        if self._dirty:
+            self._write_index()
+
+        self._file.close()
+        self._file = None
+
+    def append(self, pixels, timestamp: float = None):
+        """Add frame with RGB565 pixels stored from top to bottom"""
+        pixels = memoryview(pixels).cast('B')
+
+        if len(pixels) != self.width * self.height * 2:
+            raise RuntimeError(f'Frame of {len(pixels)} bytes does not match {self.width}x{self.height} size')
+
+        if timestamp is None:
+            timestamp = time.time()
+
+        flags = 0
+
+        if self.compress:
+            pixels = zlib.compress(pixels)
+            flags |= self.FLAG_ZLIB
+
+        self._unmap()
+
+        f = self._file
+        f.seek(self._end)
+        f.write(struct.pack(_Formats.FRAME, timestamp, flags, len(pixels)))
+        f.write(pixels)
+
+        self.frames.append(Frame(self._end + _FRAME_SIZE, timestamp, flags, len(pixels)))
+        self._end = f.tell()
+        self._dirty = True
+
+    def pixels(self, index: int):
+        """Return RGB565 pixels of frame, uncompressed data is not copied
+
+        Uncompressed pixels are a view of mapped file, it must be released before the next append() or close(),
+        otherwise they raise BufferError. Copy pixels with bytes() to keep them longer."""
+        frame = self.frames[index]
+        data = self._map()[frame.offset:frame.offset + frame.size]
+
+        if frame.flags & self.FLAG_ZLIB:
+            return zlib.decompress(data)
+
+        return data
+
+    def timestamp(self, index: int) -> float:
+        return self.frames[index].timestamp
+
+    def _map(self) -> memoryview:
+        if not self._mmap:
+            self._file.flush()
+            self._mmap = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+            self._view = memoryview(self._mmap)
+
+        return self._view
+
+    def _unmap(self):
+        if self._mmap:
+            self._view.release()
+            self._mmap.close()
+            self._mmap = None
+
+    def _load(self):
+        data = self._map()
+        magic, version, self.width, self.height, pixel_format = struct.unpack_from(_Formats.HEADER, data)
+
+        if magic != self.MAGIC or version != self.VERSION or pixel_format != self.FORMAT_RGB565:
+            raise RuntimeError(f'Unsupported capture file {self.path}')
+
+        if not self._load_index(data):
+            self._scan(data)
+
+    def _load_index(self, data: memoryview) -> bool:
+        size = len(data)
+
+        if size < _HEADER_SIZE + _FOOTER_SIZE:
+            return False
+
+        index_offset, count, magic = struct.unpack_from(_Formats.FOOTER, data, size - _FOOTER_SIZE)
+
+        if magic != self.INDEX_MAGIC or index_offset + count * _INDEX_ENTRY_SIZE + _FOOTER_SIZE != size:
+            return False
+
+        self.frames = [Frame(*entry) for entry in struct.iter_unpack(
+            _Formats.INDEX_ENTRY, data[index_offset:size - _FOOTER_SIZE])]
+        self._end = index_offset
+
+        return True
+
+    def _scan(self, data: memoryview):
+        offset = _HEADER_SIZE
+        size = len(data)
+        pixels_size = self.width * self.height * 2
+
+        while offset + _FRAME_SIZE <= size:
+            timestamp, flags, frame_size = struct.unpack_from(_Formats.FRAME, data, offset)
+            frame_offset = offset + _FRAME_SIZE
+
+            # Stop at truncated frame, or at bytes left from old index or longer frames before a crash
+            if flags & ~self.FLAG_ZLIB or not frame_size or frame_size > size - frame_offset:
+                break
+
+            if flags & self.FLAG_ZLIB:
+                if data[frame_offset] & 0x0f != 8:  # deflate method in zlib header
+                    break
+            elif frame_size != pixels_size:
+                break
+
+            self.frames.append(Frame(frame_offset, timestamp, flags, frame_size))
+            offset = frame_offset + frame_size
+
+        self._end = offset
+        self._dirty = True  # add index on close
+
+    def _write_index(self):
+        f = self._file
+        f.seek(self._end)
+
+        entries = b''.join(struct.pack(_Formats.INDEX_ENTRY, frame.offset, frame.timestamp, frame.flags, frame.size)
+                           for frame in self.frames)
+        f.write(entries)
+        f.write(struct.pack(_Formats.FOOTER, self._end, len(self.frames), self.INDEX_MAGIC))
+        f.truncate()
+
+        self._dirty = False
+
+
+def parse_range(text: str, count: int) -> range:
+    """Convert 'N', 'N-M', 'N-' or '-M' to range of frame indices"""
+    if not text:
+        return range(count)
+
+    first, separator, last = text.partition('-')
+    first = int(first) if first else 0
+    last = (int(last) if last else count - 1) if separator else first
+
+    return range(max(0, first), min(last, count - 1) + 1)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('files', metavar='cap-file', type=str, nargs='+')
+    parser.add_argument('--frames', help='list given frames only, N, N-M, N- or -M', metavar='range')
+    args = parser.parse_args()
+
+    for path in args.files:
+        with CaptureFile(path) as capture:
+            print(f'{path}: {capture.width}x{capture.height}, {len(capture)} frame(s)')
+
+            for index in parse_range(args.frames, len(capture)):
+                frame = capture.frames[index]
+                time_text = datetime.datetime.fromtimestamp(frame.timestamp).isoformat(sep=' ', timespec='milliseconds')
+                compressed = ', zlib' if frame.flags & CaptureFile.FLAG_ZLIB else ''
+                print(f'{index:6} {time_text} {frame.size} bytes{compressed}')
+
+
+if '__main__' == __name__:
+    main()
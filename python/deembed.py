@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Removes test fixtures from measured S-parameters
+#
+# Measurement is a cascade of left fixture, DUT and right fixture, so DUT's transfer (T) parameters are
+#   T_dut = inv(T_left) * T_measured * inv(T_right)
+# Fixtures are loaded from S2P files once, their S-parameters are interpolated to frequencies of measurement,
+# converted to inverse T-matrices, and kept until frequency axis changes. Matrices of all points are processed
+# together, every matrix element is a list over frequencies.
+#
+# Right fixture has port 1 at DUT side. Use reverse option if it was measured with port 1 at instrument side.
+# Sweeps of a single reflection are de-embedded with left fixture only. Sweeps of a single transmission,
+# e.g. S21 of one-path VNA, are divided by transmissions of fixtures, which ignores mismatch between them.
+
+import argparse
+import bisect
+import cmath
+import math
+import operator
+
+
+_UNITS = {'hz': 1, 'khz': 1e3, 'mhz': 1e6, 'ghz': 1e9}
+
+
+def read_touchstone(path: str) -> tuple:
+    """Return frequencies in Hz, lists of parameters over them and their names
+
+    Two-port parameters are S11 S21 S12 S22, or S21 only in S2P files saved from one-path devices."""
+    ports = 2 if path.lower().endswith('.s2p') else 1
+    unit, data_format = 1e9, 'ma'  # defaults of Touchstone format
+    line_length = 0  # numbers on the first data line
+    numbers = []
+
+    with open(path, encoding='ascii', errors='replace') as f:
+        for line in f:
+            line = line.partition('!')[0].strip()
+
+            if not line:
+                continue
+
+            if line.startswith('#'):
+                for option in line[1:].lower().split():
+                    if option in _UNITS:
+                        unit = _UNITS[option]
+                    elif option in ('ri', 'ma', 'db'):
+                        data_format = option
+            else:
+                values = line.split()
+                line_length = line_length or len(values)
+                numbers += map(float, values)
+
+    names = ('S11',) if ports == 1 else ('S21',) if line_length == 3 else ('S11', 'S21', 'S12', 'S22')
+    count = len(names)
+    step = 1 + 2 * count
+
+    if len(numbers) % step:
+        raise RuntimeError(f'Malformed {ports}-port data in {path}')
+
+    frequencies = [value * unit for value in numbers[::step]]
+    parameters = []
+
+    for index in range(count):
+        first = numbers[1 + index * 2::step]
+        second = numbers[2 + index * 2::step]
+
+        if data_format == 'ri':
+            values = list(map(complex, first, second))
+        else:
+            magnitudes = first if data_format == 'ma' else [10 ** (value / 20) for value in first]
+            values = [cmath.rect(magnitude, math.radians(angle)) for magnitude, angle in zip(magnitudes, second)]
+
+        parameters.append(values)
+
+    return frequencies, parameters, names
+
+
+def write_touchstone(path: str, frequencies, parameters: list, comment: str = 'De-embedded'):
+    with open(path, 'w', encoding='ascii') as f:
+        f.write(f'!{comment}\n# Hz S RI R 50\n')
+
+        for point, frequency in enumerate(frequencies):
+            values = ' '.join(f'{value.real:.9e} {value.imag:.9e}' for value in (column[point] for column in parameters))
+            f.write(f'{frequency:.0f} {values}\n')
+
+
+def _interpolate(frequencies: list, values: list, targets) -> list:
+    """Linear interpolation of complex values, ends are held outside of frequency range"""
+    last = len(frequencies) - 1
+    result = []
+
+    for target in targets:
+        index = bisect.bisect_right(frequencies, target)
+
+        if index == 0:
+            result.append(values[0])
+        elif index > last:
+            result.append(values[last])
+        else:
+            low, high = frequencies[index - 1], frequencies[index]
+            weight = (target - low) / (high - low)
+            result.append(values[index - 1] + (values[index] - values[index - 1]) * weight)
+
+    return result
+
+
+def s_to_t(s11: list, s21: list, s12: list, s22: list) -> tuple:
+    """Convert S-parameters of all points to T-parameters, [b1, a1] = T * [a2, b2]"""
+    t22 = [1 / value for value in s21]
+    t12 = list(map(operator.mul, s11, t22))
+    t21 = [-value * inverse for value, inverse in zip(s22, t22)]
+    t11 = [s12_value - s11_value * s22_value * inverse
+           for s11_value, s12_value, s22_value, inverse in zip(s11, s12, s22, t22)]
+    return t11, t12, t21, t22
+
+
+def t_to_s(t11: list, t12: list, t21: list, t22: list) -> tuple:
+    s21 = [1 / value for value in t22]
+    s11 = list(map(operator.mul, t12, s21))
+    s22 = [-value * inverse for value, inverse in zip(t21, s21)]
+    s12 = [(a * d - b * c) * inverse for a, b, c, d, inverse in zip(t11, t12, t21, t22, s21)]
+    return s11, s21, s12, s22
+
+
+def multiply(left: tuple, right: tuple) -> tuple:
+    """Multiply 2x2 matrices of all points, matrix is a tuple of element lists in row order"""
+    a11, a12, a21, a22 = left
+    b11, b12, b21, b22 = right
+    return ([x * y + z * w for x, y, z, w in zip(a11, b11, a12, b21)],
+            [x * y + z * w for x, y, z, w in zip(a11, b12, a12, b22)],
+            [x * y + z * w for x, y, z, w in zip(a21, b11, a22, b21)],
+            [x * y + z * w for x, y, z, w in zip(a21, b12, a22, b22)])
+
+
+def invert(matrix: tuple) -> tuple:
+    a11, a12, a21, a22 = matrix
+    inverses = [1 / (a * d - b * c) for a, b, c, d in zip(a11, a12, a21, a22)]
+    return ([d * inverse for d, inverse in zip(a22, inverses)],
+            [-b * inverse for b, inverse in zip(a12, inverses)],
+            [-c * inverse for c, inverse in zip(a21, inverses)],
+            [a * inverse for a, inverse in zip(a11, inverses)])
+
+
+class Fixture:
+    def __init__(self, path: str, reverse: bool = False):
+        self.path = path
+        self.frequencies, parameters, _ = read_touchstone(path)
+
+        if len(parameters) != 4:
+            raise RuntimeError(f'Fixture {path} is not a two-port network')
+
+        s11, s21, s12, s22 = parameters
+        self.parameters = (s22, s12, s21, s11) if reverse else (s11, s21, s12, s22)
+
+        self._axis = None  # frequencies of the last measurement
+        self._prepared = None  # interpolated S-parameters and inverse T-matrix at them
+
+    def prepare(self, frequencies) -> tuple:
+        """Return S-parameters and inverse T-matrix at given frequencies, computed again only when axis changes"""
+        if frequencies != self._axis:
+            parameters = tuple(_interpolate(self.frequencies, values, frequencies) for values in self.parameters)
+            self._axis = frequencies
+            self._prepared = parameters, invert(s_to_t(*parameters))
+
+        return self._prepared
+
+
+class Deembedder:
+    def __init__(self, left: str = None, right: str = None, reverse_right: bool = False):
+        self.left = Fixture(left) if left else None
+        self.right = Fixture(right, reverse_right) if right else None
+
+    def two_port(self, frequencies, s11: list, s21: list, s12: list, s22: list) -> tuple:
+        """Return S11, S21, S12 and S22 of DUT"""
+        matrix = s_to_t(s11, s21, s12, s22)
+
+        if self.left:
+            matrix = multiply(self.left.prepare(frequencies)[1], matrix)
+
+        if self.right:
+            matrix = multiply(matrix, self.right.prepare(frequencies)[1])
+
+        return t_to_s(*matrix)
+
+    def reflection(self, frequencies, s11: list) -> list:
+        """Return S11 of DUT, solved from measured reflection through left fixture"""
+        if not self.left:
+            return s11
+
+        (f11, f21, f12, f22), _ = self.left.prepare(frequencies)
+        return [(measured - a) / (d * (measured - a) + b * c) for measured, a, b, c, d in zip(s11, f11, f21, f12, f22)]
+
+    def transmission(self, frequencies, s21: list) -> list:
+        """Return S21 of DUT divided by transmissions of fixtures, mismatch is not taken into account"""
+        divisors = [1] * len(s21)
+
+        for fixture in (self.left, self.right):
+            if fixture:
+                divisors = list(map(operator.mul, divisors, fixture.prepare(frequencies)[0][1]))
+
+        return list(map(operator.truediv, s21, divisors))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('measurement', metavar='s1p-or-s2p-file')
+    parser.add_argument('output', metavar='s1p-or-s2p-file')
+    parser.add_argument('--left', metavar='s2p-file', help='fixture between port 1 and DUT')
+    parser.add_argument('--right', metavar='s2p-file', help='fixture between DUT and port 2')
+    parser.add_argument('--reverse-right', action='store_true', help='right fixture has port 1 at instrument side')
+    args = parser.parse_args()
+
+    deembedder = Deembedder(args.left, args.right, args.reverse_right)
+    frequencies, parameters, names = read_touchstone(args.measurement)
+
+    if len(parameters) == 4:
+        parameters = deembedder.two_port(frequencies, *parameters)
+    elif names == ('S21',):
+        parameters = [deembedder.transmission(frequencies, parameters[0])]
+    else:
+        parameters = [deembedder.reflection(frequencies, parameters[0])]
+
+    write_touchstone(args.output, frequencies, parameters)
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Frequency axis stored as uniform segments instead of explicit frequency of every point
+#
+# Every band of a sweep is a uniform grid, so it's kept as start, stop and number of points.
+# Point i of segment is start + (stop - start) * i / (count - 1), rounded for integer frequencies,
+# which reproduces frequencies of tinySA exactly. Irregular frequencies are kept as explicit list.
+# Axis behaves like a read-only list of frequencies, e.g. it can be used with bisect module.
+
+import argparse
+import bisect
+import collections.abc
+
+
+_TOLERANCE = 1.0  # Hz, of point from its segment's line while segments are detected
+_FLOAT_ERROR = 1e-3  # Hz, for frequencies that are not integers, e.g. parsed from MHz values
+
+
+class Segment:
+    __slots__ = ('first', 'start', 'stop', 'count')
+
+    def __init__(self, first: int, start: float, stop: float, count: int):
+        self.first = first  # index of the first point in axis
+        self.start = start
+        self.stop = stop
+        self.count = count
+
+    @property
+    def step(self) -> float:
+        return (self.stop - self.start) / (self.count - 1) if self.count > 1 else 0.0
+
+    def at(self, index: int, integral: bool):
+        if self.count == 1:
+            return self.start
+
+        frequency = self.start + (self.stop - self.start) * index / (self.count - 1)
+        return round(frequency) if integral else frequency
+
+
+class FrequencyAxis(collections.abc.Sequence):
+    def __init__(self, segments: list = None, values: list = None, integral: bool = True):
+        """Create axis from segments of start, stop and points, or from explicit frequencies"""
+        self.segments = []
+        self.values = values  # explicit frequencies of irregular axis
+        self.integral = integral
+
+        first = 0
+
+        for start, stop, count in segments or ():
+            self.segments.append(Segment(first, start, stop, count))
+            first += count
+
+        self._length = len(values) if values is not None else first
+        self._firsts = [segment.first for segment in self.segments]
+
+    @staticmethod
+    def from_frequencies(frequencies) -> 'FrequencyAxis':
+        """Detect uniform segments, fall back to explicit frequencies if there are too many of them"""
+        if isinstance(frequencies, FrequencyAxis):
+            return frequencies
+
+        frequencies = list(frequencies)
+        integral = all(float(frequency).is_integer() for frequency in frequencies)
+        segments = []  # start, stop and count
+        start = previous = None
+        count = 0
+
+        for frequency in frequencies:
+            if count > 1:
+                step = (previous - start) / (count - 1)
+                extends = step > 0 and abs(previous + step - frequency) <= _TOLERANCE
+            else:
+                extends = count == 1 and frequency > previous
+
+            if extends:
+                count += 1
+            else:
+                if count:
+                    segments.append((start, previous, count))
+
+                start, count = frequency, 1
+
+            previous = frequency
+
+        if count:
+            segments.append((start, previous, count))
+
+        axis = FrequencyAxis(segments, integral=integral)
+
+        # Every segment costs as much as three explicit frequencies
+        if len(segments) * 3 > len(frequencies) or not axis._matches(frequencies):
+            return FrequencyAxis(values=frequencies, integral=integral)
+
+        return axis
+
+    def __len__(self):
+        return self._length
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(self._length)[index]]
+
+        if self.values is not None:
+            return self.values[index]
+
+        if index < 0:
+            index += self._length
+
+        if not 0 <= index < self._length:
+            raise IndexError('frequency axis index out of range')
+
+        segment = self.segments[bisect.bisect_right(self._firsts, index) - 1]
+        return segment.at(index - segment.first, self.integral)
+
+    def __iter__(self):
+        if self.values is not None:
+            yield from self.values
+            return
+
+        integral = self.integral
+
+        for segment in self.segments:
+            for index in range(segment.count):
+                yield segment.at(index, integral)
+
+    def __eq__(self, other):
+        if isinstance(other, FrequencyAxis) and self.values is None and other.values is None:
+            return [(s.start, s.stop, s.count) for s in self.segments] == \
+                [(s.start, s.stop, s.count) for s in other.segments]
+
+        return isinstance(other, collections.abc.Sequence) and len(self) == len(other) and \
+            all(a == b for a, b in zip(self, other))
+
+    def __repr__(self):
+        if self.values is not None:
+            return f'FrequencyAxis({len(self.values)} explicit frequencies)'
+
+        return f'FrequencyAxis({", ".join(f"{s.start}..{s.stop}/{s.count}" for s in self.segments)})'
+
+    def is_uniform(self) -> bool:
+        return self.values is None
+
+    def nearest_index(self, frequency: float) -> int:
+        """Return index of point closest to frequency"""
+        if not self._length:
+            raise IndexError('empty frequency axis')
+
+        if self.values is not None:
+            values = self.values
+            index = min(bisect.bisect_left(values, frequency), len(values) - 1)
+
+            if index and frequency - values[index - 1] < values[index] - frequency:
+                index -= 1
+
+            return index
+
+        starts = [segment.start for segment in self.segments]
+        segment = self.segments[max(bisect.bisect_right(starts, frequency) - 1, 0)]
+        step = segment.step
+        offset = round((frequency - segment.start) / step) if step else 0
+        index = segment.first + min(max(offset, 0), segment.count - 1)
+
+        # Point beyond the end of segment can be closer to the start of the next one
+        next_index = segment.first + segment.count
+
+        if next_index < self._length and abs(self[next_index] - frequency) < abs(self[index] - frequency):
+            index = next_index
+
+        return index
+
+    def band_boundaries(self) -> list:
+        """Return indices i with step from point i to i + 1 more than twice the median step
+
+        Only gaps between uniform segments are checked, so a band with larger step than others
+        is not split into single points."""
+        if self._length < 3:
+            return []
+
+        if self.values is not None:
+            values = self.values
+            steps = sorted((values[i + 1] - values[i], 1) for i in range(len(values) - 1))
+        else:
+            steps = [(segment.step, segment.count - 1) for segment in self.segments if segment.count > 1]
+            steps += [(second.start - first.stop, 1) for first, second in zip(self.segments, self.segments[1:])]
+            steps.sort()
+
+        # Median of all steps, step of segment is repeated by its number of points
+        total = self._length - 1
+        middle = [(total - 1) // 2, total // 2]
+        middle_steps = []
+        position = 0
+
+        for step, weight in steps:
+            while middle and middle[0] < position + weight:
+                middle_steps.append(step)
+                middle.pop(0)
+
+            position += weight
+
+        threshold = sum(middle_steps) / len(middle_steps) * 2
+
+        if self.values is not None:
+            return [i for i in range(len(self.values) - 1) if self.values[i + 1] - self.values[i] > threshold]
+
+        return [first.first + first.count - 1 for first, second in zip(self.segments, self.segments[1:])
+                if second.start - first.stop > threshold]
+
+    def _matches(self, frequencies: list) -> bool:
+        if self.integral:
+            return all(a == b for a, b in zip(self, frequencies))
+
+        return all(abs(a - b) <= _FLOAT_ERROR for a, b in zip(self, frequencies))
+
+
+def read_viewer_csv(path: str) -> tuple:
+    """Read frequency axis and traces from CSV file of trace viewer"""
+    frequencies = []
+    traces = []
+    multiplier = None
+
+    with open(path, encoding='ascii') as f:
+        for line in f:
+            token, separator, rest = line.strip().partition(',')
+
+            if not separator:
+                continue
+
+            if multiplier is None:
+                multiplier = 1000000 if '.' in token else 1  # MHz or Hz
+
+            frequency = float(token) * multiplier
+            frequencies.append(round(frequency) if multiplier == 1 else frequency)
+
+            for index, value in enumerate(rest.split()):
+                if index == len(traces):
+                    traces.append([])
+
+                traces[index].append(float(value))
+
+    return FrequencyAxis.from_frequencies(frequencies), traces
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('files', metavar='csv-file', type=str, nargs='+')
+    args = parser.parse_args()
+
+    for path in args.files:
+        axis, traces = read_viewer_csv(path)
+        print(f'{path}: {len(axis)} point(s), {len(traces)} trace(s)')
+
+        if axis.is_uniform():
+            for segment in axis.segments:
+                print(f'  {segment.start} - {segment.stop}, {segment.count} point(s), step {segment.step:.3f}')
+        else:
+            print('  irregular frequencies')
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Generates synthetic sweeps to benchmark pipeline stages and trace viewer
+#
+# Spectrum is a noise floor with carriers shaped by Gaussian RBW filter, carriers can drift and come in bursts.
+# Sweeps are written to CSV file of trace viewer, one trace per sweep, to binary sweep archive,
+# or streamed to WebSocket clients at given sweep rate, e.g.
+#   loadgen.py --band 1000000 800000000 45000 --carrier 100e6:-30:5000 --random-carriers 50 --count 1000 out.swp
+
+import argparse
+import array
+import bisect
+import math
+import random
+import tempfile
+import threading
+import time
+
+import pipeline
+from freqaxis import FrequencyAxis
+
+
+_NOISE_TABLE_SIZE = 64 * 1024  # at least, table size is a power of two
+_MAX_NOISE_STRIDE = 64
+_CSV_BLOCK_POINTS = 4096  # rows written at once, so memory doesn't depend on number of sweeps
+
+# Attenuation of Gaussian filter in dB is this constant times squared ratio of offset to bandwidth
+_GAUSSIAN_DB = 40 * math.log10(2)
+
+
+class Carrier:
+    def __init__(self, frequency: float, level: float, drift: float = 0.0, period: float = 0.0, duty: float = 1.0):
+        self.frequency = frequency
+        self.level = level
+        self.drift = drift  # Hz per second
+        self.period = period  # of bursts, in seconds, zero for continuous carrier
+        self.duty = duty  # part of period when carrier is on
+
+    @staticmethod
+    def parse(text: str) -> 'Carrier':
+        """Create carrier from frequency:level[:drift[:period:duty]] text"""
+        values = [float(value) for value in text.split(':')]
+
+        if len(values) not in (2, 3, 5):
+            raise ValueError(f'Invalid carrier {text}')
+
+        return Carrier(*values)
+
+    def is_on(self, elapsed: float) -> bool:
+        return not self.period or elapsed % self.period < self.period * self.duty
+
+
+class SpectrumGenerator:
+    def __init__(self, bands: list, floor: float = -100.0, noise: float = 2.0, rbw: float = 0.0,
+                 carriers: list = None, seed: int = None):
+        """Bands are tuples of start, stop and points, they are concatenated into one sweep"""
+        frequencies = []
+
+        for start, stop, points in bands:
+            step = (stop - start) / (points - 1) if points > 1 else 0
+            frequencies += [round(start + step * index) for index in range(points)]
+
+        if not frequencies:
+            raise ValueError('No sweep points')
+
+        self.frequencies = FrequencyAxis.from_frequencies(sorted(frequencies))
+        first_start, first_stop, first_points = bands[0]
+        self.rbw = rbw or 2 * (first_stop - first_start) / max(first_points - 1, 1)
+        self.carriers = carriers or []
+
+        self._random = random.Random(seed)
+        self._start_time = None
+
+        # Noise is taken from precomputed table, generating it per point would dominate load
+        size = _NOISE_TABLE_SIZE
+
+        while size < 4 * len(self.frequencies):
+            size *= 2
+
+        self._noise = [floor + self._random.gauss(0.0, noise) for _ in range(size)]
+
+    def add_random_carriers(self, count: int, low: float = -90.0, high: float = -20.0):
+        first, last = self.frequencies[0], self.frequencies[-1]
+        rng = self._random
+
+        for _ in range(count):
+            drift = rng.choice((0.0, rng.uniform(-self.rbw, self.rbw)))
+            period, duty = rng.choice(((0.0, 1.0), (rng.uniform(0.5, 10.0), rng.uniform(0.1, 0.9))))
+            self.carriers.append(Carrier(rng.uniform(first, last), rng.uniform(low, high), drift, period, duty))
+
+    def sweep(self, timestamp: float) -> list:
+        """Return levels of all points at given time"""
+        if self._start_time is None:
+            self._start_time = timestamp
+
+        elapsed = timestamp - self._start_time
+        frequencies = self.frequencies
+        levels = self._noise_levels(len(frequencies))
+
+        rbw = self.rbw
+        reach = 4 * rbw  # carrier is far below any noise floor beyond it
+
+        for carrier in self.carriers:
+            if not carrier.is_on(elapsed):
+                continue
+
+            center = carrier.frequency + carrier.drift * elapsed
+            first = bisect.bisect_left(frequencies, center - reach)
+            last = bisect.bisect_right(frequencies, center + reach)
+
+            for index in range(first, last):
+                ratio = (frequencies[index] - center) / rbw
+                level = carrier.level - _GAUSSIAN_DB * ratio * ratio
+
+                # Sum powers of carrier and whatever is already at this point
+                levels[index] = 10 * math.log10(10 ** (levels[index] / 10) + 10 ** (level / 10))
+
+        return levels
+
+    def _noise_levels(self, count: int) -> list:
+        """Walk noise table from random position with random odd stride, wrapping around its end
+
+        Stride is coprime to table size, so no entry repeats within a sweep, and points of different sweeps
+        take unrelated entries instead of being shifted copies of the same sequence."""
+        table = self._noise
+        size = len(table)
+        stride = 2 * self._random.randrange(_MAX_NOISE_STRIDE // 2) + 1
+        position = self._random.randrange(size)
+        levels = []
+
+        while len(levels) < count:
+            stop = min(size, position + (count - len(levels)) * stride)
+            levels += table[position:stop:stride]
+            position = (position - size) % stride if stop == size else stop
+
+        return levels
+
+
+class SyntheticSource(pipeline.Source):
+    """Produces generated sweeps at given rate, as fast as possible if rate is zero"""
+
+    def __init__(self, generator: SpectrumGenerator, rate: float = 0.0, count: int = 0, name: str = None):
+        super().__init__(name)
+        self.generator = generator
+        self.rate = rate  # sweeps per second
+        self.count = count  # zero for unlimited
+
+    def produce(self, stop: threading.Event):
+        produced = 0
+        next_time = time.monotonic()
+
+        while not stop.is_set() and (not self.count or produced < self.count):
+            if self.rate:
+                delay = next_time - time.monotonic()
+
+                if delay > 0:
+                    time.sleep(delay)
+
+                next_time += 1 / self.rate
+
+            timestamp = time.time()
+            produced += 1
+
+            yield pipeline.Sweep(timestamp, self.generator.frequencies, self.generator.sweep(timestamp), self.name)
+
+
+def write_viewer_csv(path: str, generator: SpectrumGenerator, count: int, interval: float):
+    """Write frequency and levels of every sweep on one line per point
+
+    Sweeps are stored in temporary file as they are generated, then rows are read back by blocks of points."""
+    frequencies = generator.frequencies
+    points = len(frequencies)
+    itemsize = array.array('d').itemsize
+
+    with tempfile.TemporaryFile() as traces, open(path, 'w', encoding='ascii') as f:
+        for index in range(count):
+            array.array('d', generator.sweep(index * interval)).tofile(traces)
+
+        for first in range(0, points, _CSV_BLOCK_POINTS):
+            block_points = min(_CSV_BLOCK_POINTS, points - first)
+            columns = []
+
+            for index in range(count):
+                traces.seek((index * points + first) * itemsize)
+                column = array.array('d')
+                column.fromfile(traces, block_points)
+                columns.append(column)
+
+            for frequency, levels in zip(frequencies[first:first + block_points], zip(*columns)):
+                f.write(f'{frequency},  {" ".join(f"{level:.2f}" for level in levels)}\n')
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('output', nargs='?', help='CSV or archive file, not used by stream format')
+    parser.add_argument('--format', choices=('csv', 'archive', 'stream'), default='archive',
+                        help='trace viewer CSV, sweep archive or stream to WebSocket clients')
+    parser.add_argument('--band', type=float, nargs=3, action='append', metavar=('start', 'stop', 'points'),
+                        help='frequency range and points, can be repeated for multi-band sweep')
+    parser.add_argument('--floor', type=float, default=-100.0, metavar='dBm', help='average noise floor')
+    parser.add_argument('--noise', type=float, default=2.0, metavar='dB', help='standard deviation of noise floor')
+    parser.add_argument('--rbw', type=float, default=0.0, metavar='Hz',
+                        help='resolution bandwidth, two steps of the first band by default')
+    parser.add_argument('--carrier', action='append', metavar='spec', default=[],
+                        help='add carrier, frequency:level[:drift[:period:duty]], drift in Hz/s, period in seconds')
+    parser.add_argument('--random-carriers', type=int, default=0, metavar='count', help='add random carriers')
+    parser.add_argument('--count', type=int, default=100, help='number of sweeps, zero for unlimited stream')
+    parser.add_argument('--rate', type=float, default=10.0, metavar='sweeps/s',
+                        help='sweep rate of stream, also sets time between sweeps of files, zero for unpaced stream')
+    parser.add_argument('--port', type=int, default=8765, help='WebSocket port of stream')
+    parser.add_argument('--seed', type=int, help='seed of random generator for reproducible output')
+    args = parser.parse_args()
+
+    if args.format != 'stream' and not args.output:
+        parser.error(f'output file is required for {args.format} format')
+
+    bands = [(start, stop, int(points)) for start, stop, points in args.band or [(1000000, 800000000, 450)]]
+    carriers = [Carrier.parse(text) for text in args.carrier]
+    generator = SpectrumGenerator(bands, args.floor, args.noise, args.rbw, carriers, args.seed)
+    generator.add_random_carriers(args.random_carriers)
+
+    interval = 1 / args.rate if args.rate else 0.0
+    start_time = time.monotonic()
+
+    if args.format == 'csv':
+        write_viewer_csv(args.output, generator, args.count, interval)
+    elif args.format == 'archive':
+        sink = pipeline.ArchiveSink(args.output)
+        now = time.time()
+
+        for index in range(args.count):
+            timestamp = now + index * interval
+            sink.process(pipeline.Sweep(timestamp, generator.frequencies, generator.sweep(timestamp)))
+
+        sink.close()
+    else:
+        stream = pipeline.Pipeline([SyntheticSource(generator, args.rate, args.count),
+                                    pipeline.WebSocketSink(args.port)])
+        stream.run()
+        print(stream.report())
+
+    elapsed = time.monotonic() - start_time
+    points = len(generator.frequencies)
+    print(f'{points} point(s), {len(generator.carriers)} carrier(s), generated in {elapsed:.2f} s')
+
+
+if '__main__' == __name__:
+    main()
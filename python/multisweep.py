@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Sweeps several analyzers at once, sweeps of the same frame are on the same line of every device's CSV file
+# Sweeps are stamped with host time of their start, i.e. time of sent command corrected for device latency
+
+import argparse
+import threading
+import time
+
+from serial.tools import list_ports
+
+from remotecontrol import SMTVirtualCOMPort, SweepCSVSink
+
+
+_DEFAULT_SWEEP = (100000, 800000000, 450)
+
+
+def _find_devices() -> list:
+    return sorted(port.device for port in list_ports.comports()
+                  if port.vid == SMTVirtualCOMPort.VID and port.pid == SMTVirtualCOMPort.PID_GENERIC)
+
+
+class Channel:
+    """Analyzer taking part in synchronized acquisition"""
+
+    def __init__(self, name: str, device: SMTVirtualCOMPort, sweep: tuple, sink):
+        self.name = name
+        self.device = device
+        self.sweep = sweep  # start, stop and points
+        self.sink = sink
+        self.latency = 0.0  # from command sent to its execution on device, in seconds
+
+        self.start_time = 0.0
+        self.duration = 0.0
+        self.frequencies = None
+        self.levels = None
+        self.error = None
+
+    def calibrate(self, count: int):
+        round_trips = []
+
+        for _ in range(count):
+            sent = time.monotonic()
+            self.device.send('')
+            self.device.receive()
+            round_trips.append(time.monotonic() - sent)
+
+        # The fastest round trip has the least queuing, half of it is one way latency
+        self.latency = min(round_trips) / 2
+
+    def acquire(self, barrier: threading.Barrier):
+        try:
+            barrier.wait()
+
+            sent = time.monotonic()
+            self.frequencies, self.levels = self.device.scan(*self.sweep)
+            received = time.monotonic()
+
+            self.start_time = sent + self.latency
+            self.duration = received - sent - self.latency * 2
+        except Exception as ex:
+            self.error = ex
+            barrier.abort()
+
+
+class SynchronizedAcquisition:
+    def __init__(self, channels: list):
+        self.channels = channels
+        self.frames = 0
+        self.total_skew = 0.0
+        self.max_skew = 0.0
+
+        self._barrier = threading.Barrier(len(channels))
+        self._clock_offset = time.time() - time.monotonic()
+
+    def calibrate(self, count: int = 10):
+        for channel in self.channels:
+            channel.calibrate(count)
+
+    def acquire(self) -> float:
+        """Sweep all devices at once, return skew of sweep starts"""
+        # Failure of previous frame breaks barrier, every frame starts afresh
+        self._barrier.reset()
+
+        for channel in self.channels:
+            channel.error = None
+
+        threads = [threading.Thread(target=channel.acquire, args=(self._barrier,)) for channel in self.channels]
+
+        for thread in threads:
+            thread.start()
+
+        for thread in threads:
+            thread.join()
+
+        errors = [channel.error for channel in self.channels if channel.error]
+
+        if errors:
+            # Channels waiting for failed one report broken barrier, raise the cause instead
+            causes = [error for error in errors if not isinstance(error, threading.BrokenBarrierError)]
+            raise (causes or errors)[0]
+
+        starts = [channel.start_time for channel in self.channels]
+        skew = max(starts) - min(starts)
+
+        self.frames += 1
+        self.total_skew += skew
+        self.max_skew = max(self.max_skew, skew)
+
+        for channel in self.channels:
+            channel.sink(None, channel.start_time + self._clock_offset, channel.frequencies, channel.levels)
+
+        return skew
+
+    def run(self, count: int, interval: float = 0.0):
+        next_time = time.monotonic()
+
+        for _ in range(count):
+            delay = next_time - time.monotonic()
+
+            if delay > 0:
+                time.sleep(delay)
+
+            next_time += interval
+            self.acquire()
+
+    def report(self) -> str:
+        average = self.total_skew / self.frames if self.frames else 0.0
+        lines = [f'{self.frames} frame(s), start skew average {average * 1000:.2f} ms, worst {self.max_skew * 1000:.2f} ms']
+
+        for channel in self.channels:
+            lines.append(f'{channel.name}: latency {channel.latency * 1000:.2f} ms,'
+                         f' last sweep {channel.duration * 1000:.1f} ms')
+
+        return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--device', action='append', metavar='device-name',
+                        help='add device explicitly, all connected tinySA devices are used by default')
+    parser.add_argument('--sweep', type=int, nargs=3, action='append', metavar=('start', 'stop', 'points'),
+                        help='frequency range and points, once for all devices or once per device in their order')
+    parser.add_argument('--count', type=int, default=10, help='number of frames to acquire')
+    parser.add_argument('--interval', type=float, default=0.0, metavar='seconds',
+                        help='time between starts of frames, back to back by default')
+    parser.add_argument('--calibration', type=int, default=10, metavar='count',
+                        help='number of round trips to measure latency of every device')
+    parser.add_argument('--prefix', default='multi', help='prefix of CSV files, device index is appended to it')
+    parser.add_argument('--verbose', action='store_true', help='enable verbose output')
+    args = parser.parse_args()
+
+    device_names = args.device or _find_devices()
+
+    if not device_names:
+        raise OSError('No devices found')
+
+    sweeps = args.sweep or [_DEFAULT_SWEEP]
+
+    if len(sweeps) == 1:
+        sweeps *= len(device_names)
+    elif len(sweeps) != len(device_names):
+        parser.error('number of sweeps does not match number of devices')
+
+    channels = []
+
+    for index, (device_name, sweep) in enumerate(zip(device_names, sweeps)):
+        device = SMTVirtualCOMPort(device_name, args.verbose)
+
+        if not device.is_tinysa_ultra():
+            raise RuntimeError(f'Device {device_name} is not tinySA ULTRA')
+
+        channels.append(Channel(device_name, device, tuple(sweep), SweepCSVSink(f'{args.prefix}_{index}.csv')))
+
+    acquisition = SynchronizedAcquisition(channels)
+    acquisition.calibrate(args.calibration)
+
+    try:
+        acquisition.run(args.count, args.interval)
+    except KeyboardInterrupt:
+        pass
+
+    print(acquisition.report())
+
+
+if '__main__' == __name__:
+    main()
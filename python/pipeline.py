@@ -0,0 +1,1240 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Acquisition pipeline, a source of sweeps followed by transforms and sinks
+#
+# Every stage runs in its own thread, stages are connected by bounded queues of sweep batches.
+# When a stage fails, source is stopped, sweeps in flight are flushed, and pipeline run raises the error.
+# Sinks pass sweeps through, so several of them can be chained. Pipeline is defined in JSON file, e.g.
+#   {
+#       "stages": [
+#           {"type": "serial", "start": 88000000, "stop": 108000000, "points": 450},
+#           {"type": "accumulate", "count": 4},
+#           {"type": "threshold", "level": -60},
+#           {"type": "csv", "path": "detections.csv"}
+#       ]
+#   }
+
+import argparse
+import array
+import base64
+import bisect
+import hashlib
+import http.server
+import itertools
+import json
+import math
+import operator
+import os
+import queue
+import socket
+import struct
+import sys
+import threading
+import time
+
+import deembed
+import spurmask
+import tinysa4preset
+from freqaxis import FrequencyAxis
+from remotecontrol import SMTVirtualCOMPort, SweepCSVSink
+
+
+_DEFAULT_QUEUE_SIZE = 16
+_DEFAULT_BATCH_SIZE = 8
+
+
+class Sweep:
+    __slots__ = ('timestamp', 'frequencies', 'values', 'source', 'detections')
+
+    def __init__(self, timestamp: float, frequencies: list, values: list, source: str = ''):
+        self.timestamp = timestamp  # host time of sweep start
+        self.frequencies = frequencies
+        self.values = values  # levels, or complex values of VNA measurement, or tuples of them for several ones
+        self.source = source
+        self.detections = None  # list of frequency and value pairs found by detectors
+
+    def to_dict(self) -> dict:
+        values = self.values
+
+        if values and isinstance(values[0], complex):
+            values = [[value.real, value.imag] for value in values]
+        elif values and isinstance(values[0], tuple):
+            values = [[[value.real, value.imag] for value in point] for point in values]
+
+        return {
+            'timestamp': self.timestamp,
+            'source': self.source,
+            'frequencies': list(self.frequencies),
+            'values': values,
+            'detections': self.detections,
+        }
+
+
+class StageMetrics:
+    def __init__(self):
+        self.start = time.monotonic()
+        self.items_in = 0
+        self.items_out = 0
+        self.batches = 0
+        self.busy = 0.0  # seconds spent in processing
+        self.max_batch_time = 0.0
+        self.total_latency = 0.0  # from sweep start to leaving stage
+        self.max_latency = 0.0
+
+    def add_batch(self, items_in: int, outputs: list, busy: float):
+        self.items_in += items_in
+        self.items_out += len(outputs)
+        self.batches += 1
+        self.busy += busy
+        self.max_batch_time = max(self.max_batch_time, busy)
+
+        now = time.time()
+
+        for sweep in outputs:
+            latency = now - sweep.timestamp
+            self.total_latency += latency
+            self.max_latency = max(self.max_latency, latency)
+
+    def report(self) -> str:
+        elapsed = time.monotonic() - self.start
+        rate = self.items_in / elapsed if elapsed > 0 else 0.0
+        service = self.busy / self.items_in * 1000 if self.items_in else 0.0
+        latency = self.total_latency / self.items_out * 1000 if self.items_out else 0.0
+        batch = self.items_in / self.batches if self.batches else 0.0
+
+        return f'{self.items_in} in, {self.items_out} out, {rate:.1f} sweeps/s, {service:.2f} ms per sweep,' \
+            f' {batch:.1f} sweeps per batch, latency average {latency:.1f} ms, worst {self.max_latency * 1000:.1f} ms'
+
+
+class Stage:
+    """Transform or sink, returns sweeps to pass to the next stage"""
+
+    def __init__(self, name: str = None):
+        self.name = name or type(self).__name__
+        self.metrics = StageMetrics()
+        self.pipeline = None  # set when stage is added to pipeline
+
+    def process(self, sweep: Sweep) -> list:
+        return [sweep]
+
+    def close(self):
+        pass
+
+
+class Source(Stage):
+    def produce(self, stop: threading.Event):
+        """Generate sweeps until exhausted or stopped"""
+        raise NotImplementedError
+
+
+class SerialSweepSource(Source):
+    def __init__(self, start: int, stop: int, points: int = 450, device: str = None, count: int = 0,
+                 name: str = None):
+        super().__init__(name)
+        self.device = SMTVirtualCOMPort(device)
+        self.sweep = (start, stop, points)
+        self.count = count  # zero for unlimited
+
+    def produce(self, stop: threading.Event):
+        produced = 0
+
+        while not stop.is_set() and (not self.count or produced < self.count):
+            timestamp = time.time()
+            frequencies, levels = self.device.scan(*self.sweep)
+            produced += 1
+
+            yield Sweep(timestamp, frequencies, levels, self.name)
+
+
+class LibreVNASource(Source):
+    """Collects points streamed by LibreVNA-GUI into sweeps"""
+
+    def __init__(self, measurement: str, host: str = 'localhost', port: int = 19542, stream_port: int = 19001,
+                 count: int = 0, name: str = None):
+        super().__init__(name)
+
+        from libreVNA import libreVNA
+
+        self.measurement = measurement  # e.g. S11 for VNA or PORT1 for spectrum analyzer stream, or list of them
+        self.count = count
+        self.vna = libreVNA(host, port)
+        self.stream_port = stream_port
+
+        self._points = queue.Queue()
+
+    def produce(self, stop: threading.Event):
+        self.vna.add_live_callback(self.stream_port, self._points.put)
+
+        try:
+            produced = 0
+            timestamp = time.time()
+            frequencies = []
+            values = []
+
+            if isinstance(self.measurement, str):
+                measurement = operator.itemgetter(self.measurement)
+            else:
+                measurement = operator.itemgetter(*self.measurement)  # tuple of values per point
+
+            while not stop.is_set() and (not self.count or produced < self.count):
+                try:
+                    point = self._points.get(timeout=0.2)
+                except queue.Empty:
+                    continue
+
+                if point['pointNum'] == 0 and frequencies:
+                    yield Sweep(timestamp, frequencies, values, self.name)
+                    produced += 1
+                    timestamp = time.time()
+                    frequencies = []
+                    values = []
+
+                frequencies.append(point['frequency'])
+                values.append(measurement(point['measurements']))
+        finally:
+            self.vna.remove_live_callback(self.stream_port, self._points.put)
+
+
+class CSVReplaySource(Source):
+    """Reads sweeps written by CSV sink, or a single sweep of frequency and level lines"""
+
+    def __init__(self, path: str, realtime: bool = False, name: str = None):
+        super().__init__(name)
+        self.path = path
+        self.realtime = realtime  # keep original time between sweeps
+
+    def produce(self, stop: threading.Event):
+        with open(self.path, encoding='ascii') as f:
+            header = f.readline()
+
+            if not header.startswith('time,'):
+                frequencies, levels = [], []
+
+                for line in [header] + f.readlines():
+                    if line.strip():
+                        frequency, level = line.split(',')[:2]
+                        frequencies.append(int(frequency))
+                        levels.append(float(level))
+
+                yield Sweep(time.time(), FrequencyAxis.from_frequencies(frequencies), levels, self.name)
+                return
+
+            frequencies = FrequencyAxis.from_frequencies(int(frequency) for frequency in header.split(',')[1:])
+            previous = None
+
+            for line in f:
+                if stop.is_set():
+                    break
+
+                values = line.split(',')
+                timestamp = float(values[0])
+
+                if self.realtime and previous is not None:
+                    time.sleep(max(timestamp - previous, 0.0))
+
+                previous = timestamp
+                yield Sweep(timestamp, frequencies, [float(value) for value in values[1:]], self.name)
+
+
+class AccumulateTransform(Stage):
+    """Combines every given number of sweeps to one with average, maximum or minimum of values"""
+
+    def __init__(self, count: int, mode: str = 'average', name: str = None):
+        super().__init__(name)
+        self.count = count
+        self.mode = mode
+        self._sweeps = []
+
+    def process(self, sweep: Sweep) -> list:
+        sweeps = self._sweeps
+        sweeps.append(sweep)
+
+        if len(sweeps) < self.count:
+            return []
+
+        columns = zip(*(entry.values for entry in sweeps))
+
+        if self.mode == 'max':
+            values = [max(column) for column in columns]
+        elif self.mode == 'min':
+            values = [min(column) for column in columns]
+        else:
+            values = [sum(column) / self.count for column in columns]
+
+        self._sweeps = []
+        return [Sweep(sweeps[0].timestamp, sweep.frequencies, values, sweep.source)]
+
+
+class DecimateTransform(Stage):
+    """Keeps every given sweep, and the maximum value of every given number of points"""
+
+    def __init__(self, sweeps: int = 1, points: int = 1, name: str = None):
+        super().__init__(name)
+        self.sweeps = sweeps
+        self.points = points
+        self._skipped = 0
+
+    def process(self, sweep: Sweep) -> list:
+        self._skipped += 1
+
+        if self._skipped < self.sweeps:
+            return []
+
+        self._skipped = 0
+        step = self.points
+
+        if step > 1:
+            values = sweep.values
+            frequencies = sweep.frequencies[::step]
+            values = [max(values[index:index + step]) for index in range(0, len(values), step)]
+            sweep = Sweep(sweep.timestamp, frequencies, values, sweep.source)
+
+        return [sweep]
+
+
+class DeembedTransform(Stage):
+    """Removes fixtures from VNA sweeps, outputs values of one S-parameter of DUT
+
+    Sweeps of S11, S21, S12 and S22 tuples are fully de-embedded. Sweeps of one measurement are taken as
+    the given parameter, S11 is de-embedded with left fixture, S21 is divided by transmissions of fixtures."""
+
+    _PARAMETERS = ('S11', 'S21', 'S12', 'S22')  # order of tuple values, the same as in S2P file
+
+    def __init__(self, left: str = None, right: str = None, reverse_right: bool = False, parameter: str = 'S21',
+                 name: str = None):
+        super().__init__(name)
+
+        if parameter not in self._PARAMETERS:
+            raise RuntimeError(f'Unknown S-parameter {parameter}')
+
+        self.deembedder = deembed.Deembedder(left, right, reverse_right)
+        self.parameter = parameter
+
+    def process(self, sweep: Sweep) -> list:
+        values = sweep.values
+        frequencies = sweep.frequencies
+
+        if values and isinstance(values[0], tuple):
+            parameters = self.deembedder.two_port(frequencies, *zip(*values))
+            values = parameters[self._PARAMETERS.index(self.parameter)]
+        elif self.parameter == 'S11':
+            values = self.deembedder.reflection(frequencies, values)
+        elif self.parameter == 'S21':
+            values = self.deembedder.transmission(frequencies, values)
+        else:
+            raise RuntimeError(f'{self.parameter} requires sweeps of all four S-parameters')
+
+        return [Sweep(sweep.timestamp, frequencies, values, sweep.source)]
+
+
+class ThresholdDetector(Stage):
+    """Passes only sweeps with values above level, listing such points as detections"""
+
+    def __init__(self, level: float, name: str = None):
+        super().__init__(name)
+        self.level = level
+
+    def process(self, sweep: Sweep) -> list:
+        level = self.level
+
+        if max(sweep.values) <= level:
+            return []
+
+        sweep.detections = [(frequency, value) for frequency, value in zip(sweep.frequencies, sweep.values)
+                            if value > level]
+        return [sweep]
+
+
+def _spur_model(preset: str):
+    return spurmask.SpurModel(tinysa4preset.load(preset)) if preset else None
+
+
+class CFARDetector(Stage):
+    """Flags points exceeding noise floor by margin, writes events of adjacent flagged points to CSV file
+
+    Noise floor of every point is averaged over time, flagged points affect it ten times slower,
+    so signals that stay for long become a part of the floor. Threshold is the higher one of point's floor
+    and average floor of training points on both sides of it, excluding guard points, i.e. cell averaging CFAR
+    over logarithmic levels. Memory does not depend on number of sweeps.
+    Points of internal spurs predicted from optional preset are never flagged."""
+
+    def __init__(self, margin: float = 10.0, guard: int = 2, training: int = 8, alpha: float = 0.05,
+                 warmup: int = 10, path: str = 'events.csv', preset: str = None, name: str = None):
+        super().__init__(name)
+        self.margin = margin  # dB
+        self.guard = guard  # points
+        self.training = training  # points on every side
+        self.alpha = alpha  # weight of new level in noise floor average
+        self.warmup = warmup  # sweeps to learn noise floor before detection
+        self.path = path
+        self.events = 0
+
+        self._spurs = _spur_model(preset)
+        self._floor = None
+        self._sweeps = 0
+        self._windows = None  # indices of training windows
+        self._active = []  # events still present in the last sweep
+        self._last_time = 0.0
+        self._file = None
+
+    def process(self, sweep: Sweep) -> list:
+        levels = sweep.values
+
+        if not self._floor or len(self._floor) != len(levels):
+            self._reset(len(levels))
+            self._floor = list(levels)
+
+        self._sweeps += 1
+        self._last_time = sweep.timestamp
+        floor = self._floor
+
+        if self._sweeps > self.warmup:
+            flags = list(map(operator.gt, levels, self._thresholds()))
+
+            if self._spurs:
+                flags = [flag and not masked for flag, masked in zip(flags, self._spurs.mask(sweep.frequencies))]
+        else:
+            flags = [False] * len(levels)
+
+        alpha = self.alpha
+        slow_alpha = alpha / 10
+        self._floor = [old + (slow_alpha if flag else alpha) * (level - old)
+                       for old, level, flag in zip(floor, levels, flags)]
+
+        runs = self._runs(sweep.frequencies, levels, flags)
+        self._track(sweep.timestamp, runs)
+
+        if runs:
+            sweep.detections = [(frequency, level) for frequency, level, flag in zip(sweep.frequencies, levels, flags)
+                                if flag]
+
+        return [sweep]
+
+    def close(self):
+        for event in self._active:
+            self._write(event, self._last_time)
+
+        self._active = []
+
+        if self._file:
+            self._file.close()
+
+    def _reset(self, count: int):
+        self._sweeps = 0
+        lead_first, lead_last, trail_first, trail_last, counts = [], [], [], [], []
+        guard, training = self.guard, self.training
+
+        # Training windows clipped at sweep edges, as prefix sum indices
+        for index in range(count):
+            lead = (max(index - guard - training, 0), max(index - guard, 0))
+            trail = (min(index + guard + 1, count), min(index + guard + training + 1, count))
+            lead_first.append(lead[0])
+            lead_last.append(lead[1])
+            trail_first.append(trail[0])
+            trail_last.append(trail[1])
+            counts.append(max(lead[1] - lead[0] + trail[1] - trail[0], 1))
+
+        self._windows = lead_first, lead_last, trail_first, trail_last, counts
+
+    def _thresholds(self) -> list:
+        sums = list(itertools.accumulate(self._floor, initial=0.0))
+        lead_first, lead_last, trail_first, trail_last, counts = self._windows
+        take = sums.__getitem__
+
+        lead = map(operator.sub, map(take, lead_last), map(take, lead_first))
+        trail = map(operator.sub, map(take, trail_last), map(take, trail_first))
+        averages = map(operator.truediv, map(operator.add, lead, trail), counts)
+        margin = self.margin
+
+        return [level + margin for level in map(max, self._floor, averages)]
+
+    @staticmethod
+    def _runs(frequencies: list, levels: list, flags: list) -> list:
+        """Return lowest and highest frequency, peak frequency and level of every group of adjacent flagged points"""
+        runs = []
+        index = 0
+
+        for flagged, group in itertools.groupby(flags):
+            size = len(list(group))
+
+            if flagged:
+                group_levels = levels[index:index + size]
+                peak = max(group_levels)
+                peak_frequency = frequencies[index + group_levels.index(peak)]
+                runs.append((frequencies[index], frequencies[index + size - 1], peak_frequency, peak))
+
+            index += size
+
+        return runs
+
+    def _track(self, timestamp: float, runs: list):
+        active = []
+
+        for low, high, frequency, level in runs:
+            # Continue event that overlaps in frequency
+            for event in self._active:
+                if low <= event['high'] and high >= event['low']:
+                    self._active.remove(event)
+                    break
+            else:
+                event = {'start': timestamp, 'low': low, 'high': high, 'frequency': frequency, 'level': level, 'sweeps': 0}
+                self.events += 1
+
+            event['low'] = min(event['low'], low)
+            event['high'] = max(event['high'], high)
+            event['sweeps'] += 1
+
+            if level > event['level']:
+                event['frequency'] = frequency
+                event['level'] = level
+
+            active.append(event)
+
+        # Events not seen in this sweep have ended
+        for event in self._active:
+            self._write(event, timestamp)
+
+        self._active = active
+
+    def _write(self, event: dict, end: float):
+        if not self._file:
+            header = not os.path.exists(self.path)
+            self._file = open(self.path, 'a', encoding='ascii')
+
+            if header:
+                self._file.write('start,duration,frequency,level,low,high,sweeps\n')
+
+        self._file.write(f'{event["start"]:.3f},{end - event["start"]:.3f},{event["frequency"]},{event["level"]:.2f},'
+                         f'{event["low"]},{event["high"]},{event["sweeps"]}\n')
+        self._file.flush()
+
+
+class Track:
+    def __init__(self, number: int, timestamp: float, frequency: float, level: float):
+        self.number = number
+        self.first_time = timestamp
+        self.last_time = timestamp
+        self.first_frequency = frequency
+        self.frequency = frequency
+        self.low = frequency
+        self.high = frequency
+        self.drift = 0.0  # Hz per second
+        self.hits = 0
+        self.level_mean = 0.0
+        self.level_m2 = 0.0  # sum of squared deviations
+        self.level_max = level
+
+        self.add(timestamp, frequency, level)
+
+    def predict(self, timestamp: float) -> float:
+        return self.frequency + self.drift * (timestamp - self.last_time)
+
+    def add(self, timestamp: float, frequency: float, level: float):
+        interval = timestamp - self.last_time
+
+        if interval > 0:
+            drift = (frequency - self.frequency) / interval
+            self.drift = drift if self.hits == 1 else (self.drift + drift) / 2
+
+        self.last_time = timestamp
+        self.frequency = frequency
+        self.low = min(self.low, frequency)
+        self.high = max(self.high, frequency)
+        self.level_max = max(self.level_max, level)
+
+        # Welford's online algorithm
+        self.hits += 1
+        delta = level - self.level_mean
+        self.level_mean += delta / self.hits
+        self.level_m2 += delta * (level - self.level_mean)
+
+    def row(self, state: str) -> str:
+        deviation = math.sqrt(self.level_m2 / self.hits)
+        return f'{self.number},{state},{self.first_time:.3f},{self.last_time - self.first_time:.3f},' \
+            f'{self.first_frequency:.0f},{self.frequency:.0f},{self.low:.0f},{self.high:.0f},{self.drift:.1f},' \
+            f'{self.hits},{self.level_mean:.2f},{deviation:.2f},{self.level_max:.2f}'
+
+
+class PeakTracker(Stage):
+    """Follows peaks across sweeps, writes table of tracks to CSV file when they end
+
+    Peaks are the strongest points of adjacent detections of previous stage, e.g. CFAR detector,
+    or local maxima above level.
+    Every peak continues the track with the nearest predicted frequency within gate, the closest pairs first.
+    Track ends when it has no peaks for given time, tracks with too few peaks are dropped.
+    Peaks at internal spurs and images predicted from optional preset are ignored."""
+
+    TABLE_HEADER = 'track,state,start,duration,first_frequency,frequency,low,high,drift,hits,level_mean,level_deviation,level_max'
+
+    def __init__(self, gate: float = 100000, stale: float = 5.0, level: float = -80.0, min_hits: int = 3,
+                 path: str = 'tracks.csv', viewer_path: str = None, preset: str = None, name: str = None):
+        super().__init__(name)
+        self.gate = gate  # Hz
+        self.stale = stale  # seconds
+        self.level = level
+        self.min_hits = min_hits
+        self.path = path
+        self.viewer_path = viewer_path  # frequency, average and maximum levels of tracks, in trace viewer format
+        self.tracks = []
+        self.tracks_total = 0
+
+        self._spurs = _spur_model(preset)
+        self._file = None
+        self._ended = []  # confirmed tracks for viewer file, kept only when it's written
+
+    def process(self, sweep: Sweep) -> list:
+        timestamp = sweep.timestamp
+        if sweep.detections is not None:
+            peaks = self._strongest(sweep.frequencies, sweep.detections)
+        else:
+            peaks = self._peaks(sweep.frequencies, sweep.values)
+
+        if self._spurs:
+            peaks = self._spurs.filter(sweep.frequencies, peaks)
+
+        tracks = self.tracks
+        predictions = sorted((track.predict(timestamp), index) for index, track in enumerate(tracks))
+        predicted = [prediction for prediction, _ in predictions]
+        pairs = []
+
+        for peak_index, (frequency, _) in enumerate(peaks):
+            position = bisect.bisect_left(predicted, frequency)
+
+            # Nearest prediction is at either side of peak
+            for candidate in (position - 1, position):
+                if 0 <= candidate < len(predicted):
+                    distance = abs(predicted[candidate] - frequency)
+
+                    if distance <= self.gate:
+                        pairs.append((distance, peak_index, predictions[candidate][1]))
+
+        pairs.sort()
+        used_peaks = set()
+        used_tracks = set()
+
+        for _, peak_index, track_index in pairs:
+            if peak_index in used_peaks or track_index in used_tracks:
+                continue
+
+            used_peaks.add(peak_index)
+            used_tracks.add(track_index)
+            tracks[track_index].add(timestamp, *peaks[peak_index])
+
+        for peak_index, (frequency, level) in enumerate(peaks):
+            if peak_index not in used_peaks:
+                self.tracks_total += 1
+                tracks.append(Track(self.tracks_total, timestamp, frequency, level))
+
+        self._retire(timestamp)
+        return [sweep]
+
+    def close(self):
+        for track in self.tracks:
+            self._write(track, 'active')
+
+        if self.viewer_path:
+            self._write_viewer(self._ended + [track for track in self.tracks if track.hits >= self.min_hits])
+
+        if self._file:
+            self._file.close()
+
+    def _peaks(self, frequencies: list, levels: list) -> list:
+        level = self.level
+        peaks = []
+
+        for index in range(1, len(levels) - 1):
+            value = levels[index]
+
+            if value > level and levels[index - 1] < value >= levels[index + 1]:
+                peaks.append((frequencies[index], value))
+
+        return peaks
+
+    @staticmethod
+    def _strongest(frequencies, detections: list) -> list:
+        """Reduce detections to one per run of adjacent points, so a wide signal does not start many tracks"""
+        peaks = []
+        previous = None
+
+        for frequency, level in detections:
+            index = bisect.bisect_left(frequencies, frequency)
+
+            if previous is not None and index == previous + 1:
+                if level > peaks[-1][1]:
+                    peaks[-1] = (frequency, level)
+            else:
+                peaks.append((frequency, level))
+
+            previous = index
+
+        return peaks
+
+    def _retire(self, timestamp: float):
+        stale_time = timestamp - self.stale
+        active = []
+
+        for track in self.tracks:
+            if track.last_time >= stale_time:
+                active.append(track)
+            elif track.hits >= self.min_hits:
+                self._write(track, 'ended')
+
+                if self.viewer_path:
+                    self._ended.append(track)
+
+        self.tracks = active
+
+    def _write(self, track: Track, state: str):
+        if track.hits < self.min_hits:
+            return
+
+        if not self._file:
+            header = not os.path.exists(self.path)
+            self._file = open(self.path, 'a', encoding='ascii')
+
+            if header:
+                self._file.write(self.TABLE_HEADER + '\n')
+
+        self._file.write(track.row(state) + '\n')
+        self._file.flush()
+
+    def _write_viewer(self, tracks: list):
+        with open(self.viewer_path, 'w', encoding='ascii') as f:
+            for track in sorted(tracks, key=lambda entry: entry.frequency):
+                f.write(f'{track.frequency:.0f},  {track.level_mean:.2f} {track.level_max:.2f}\n')
+
+
+class CSVSink(Stage):
+    def __init__(self, path: str, name: str = None):
+        super().__init__(name)
+        self._sink = SweepCSVSink(path)
+
+    def process(self, sweep: Sweep) -> list:
+        self._sink(None, sweep.timestamp, sweep.frequencies, sweep.values)
+        return [sweep]
+
+
+class ArchiveSink(Stage):
+    """Appends sweeps to binary file, see ArchiveSource for its layout"""
+
+    def __init__(self, path: str, name: str = None):
+        super().__init__(name)
+        self._file = open(path, 'ab')
+
+        if not self._file.tell():
+            self._file.write(ArchiveSource.MAGIC)
+
+    def process(self, sweep: Sweep) -> list:
+        f = self._file
+        f.write(struct.pack(ArchiveSource.RECORD_FORMAT, sweep.timestamp, len(sweep.values)))
+        f.write(array.array('Q', map(round, sweep.frequencies)))
+        f.write(array.array('f', sweep.values))
+        return [sweep]
+
+    def close(self):
+        self._file.close()
+
+
+class ArchiveSource(Source):
+    """Reads binary archive, magic followed by records of timestamp, number of points,
+    uint64 frequencies and float32 levels, all little endian"""
+
+    MAGIC = b'A6RSWP01'
+    RECORD_FORMAT = '<dI'
+    RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+
+    def __init__(self, path: str, name: str = None):
+        super().__init__(name)
+        self.path = path
+
+    def produce(self, stop: threading.Event):
+        with open(self.path, 'rb') as f:
+            if f.read(len(self.MAGIC)) != self.MAGIC:
+                raise RuntimeError(f'Unsupported sweep archive {self.path}')
+
+            raw_frequencies = axis = None
+
+            while not stop.is_set():
+                record = f.read(self.RECORD_SIZE)
+
+                if len(record) < self.RECORD_SIZE:
+                    break
+
+                timestamp, count = struct.unpack(self.RECORD_FORMAT, record)
+                frequencies = array.array('Q')
+                frequencies.fromfile(f, count)
+                levels = array.array('f')
+                levels.fromfile(f, count)
+
+                # Sweeps usually share frequencies, detect segments of axis only when they change
+                if frequencies != raw_frequencies:
+                    raw_frequencies = frequencies
+                    axis = FrequencyAxis.from_frequencies(frequencies.tolist())
+
+                yield Sweep(timestamp, axis, levels.tolist(), self.name)
+
+
+class WebSocketSink(Stage):
+    """Broadcasts sweeps as JSON text messages to all connected WebSocket clients"""
+
+    # https://datatracker.ietf.org/doc/html/rfc6455#section-1.3
+    GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+    def __init__(self, port: int = 8765, host: str = '', name: str = None):
+        super().__init__(name)
+        self._clients = []
+        self._lock = threading.Lock()
+
+        self._server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self._server.bind((host, port))
+        self._server.listen()
+
+        threading.Thread(target=self._accept, daemon=True).start()
+
+    def process(self, sweep: Sweep) -> list:
+        if not self._clients:
+            return [sweep]
+
+        payload = json.dumps(sweep.to_dict()).encode()
+        size = len(payload)
+
+        # https://datatracker.ietf.org/doc/html/rfc6455#section-5.2, final text frame, not masked
+        if size < 126:
+            header = struct.pack('!2B', 0x81, size)
+        elif size < 65536:
+            header = struct.pack('!2BH', 0x81, 126, size)
+        else:
+            header = struct.pack('!2BQ', 0x81, 127, size)
+
+        with self._lock:
+            for client in list(self._clients):
+                try:
+                    client.sendall(header + payload)
+                except OSError:
+                    client.close()
+                    self._clients.remove(client)
+
+        return [sweep]
+
+    def close(self):
+        self._server.close()
+
+        with self._lock:
+            for client in self._clients:
+                client.close()
+
+    def _accept(self):
+        while True:
+            try:
+                client, _ = self._server.accept()
+            except OSError:
+                break  # closed
+
+            try:
+                self._handshake(client)
+            except (OSError, ValueError):
+                client.close()
+                continue
+
+            with self._lock:
+                self._clients.append(client)
+
+    def _handshake(self, client: socket.socket):
+        request = b''
+
+        while b'\r\n\r\n' not in request:
+            data = client.recv(4096)
+
+            if not data:
+                raise ValueError('Incomplete request')
+
+            request += data
+
+        key = None
+
+        for line in request.decode('latin_1').split('\r\n'):
+            name, _, value = line.partition(':')
+
+            if name.strip().lower() == 'sec-websocket-key':
+                key = value.strip()
+
+        if not key:
+            raise ValueError('Not a WebSocket request')
+
+        accept = base64.b64encode(hashlib.sha1((key + self.GUID).encode()).digest()).decode()
+        client.sendall(f'HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                       f'Sec-WebSocket-Accept: {accept}\r\n\r\n'.encode())
+
+
+class PrometheusSink(Stage):
+    """Serves levels of markers, peaks and channel powers of frequency windows, device and stage statistics
+    in Prometheus text format, from values cached when sweeps pass through"""
+
+    DEFAULT_BUCKETS = (-120.0, -110.0, -100.0, -90.0, -80.0, -70.0, -60.0, -50.0, -40.0, -30.0, -20.0, -10.0, 0.0)
+
+    def __init__(self, port: int = 9101, host: str = '', windows: list = None, markers: list = None,
+                 buckets: list = None, name: str = None):
+        super().__init__(name)
+        self.windows = windows or []  # dictionaries with name, start and stop frequencies
+        self.markers = markers or []  # frequencies
+        self.buckets = sorted(buckets or self.DEFAULT_BUCKETS)
+
+        self._lock = threading.Lock()
+        self._grid = None  # frequencies of sweeps
+        self._ranges = None  # indices of windows in sweep
+        self._marker_indices = None
+        self._values = {}  # sample text by name and labels
+        self._histograms = {window['name']: [[0] * len(self.buckets), 0, 0.0] for window in self.windows}
+        self._sweeps = 0
+
+        sink = self
+
+        class Handler(http.server.BaseHTTPRequestHandler):
+            def do_GET(self):
+                body = sink.render().encode()
+                self.send_response(200)
+                self.send_header('Content-Type', 'text/plain; version=0.0.4')
+                self.send_header('Content-Length', str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+            def log_message(self, *args):
+                pass
+
+        self._server = http.server.ThreadingHTTPServer((host, port), Handler)
+        threading.Thread(target=self._server.serve_forever, daemon=True).start()
+
+    def process(self, sweep: Sweep) -> list:
+        frequencies = sweep.frequencies
+        levels = sweep.values
+
+        if levels and isinstance(levels[0], complex):
+            levels = [20 * math.log10(abs(value) or 1e-12) for value in levels]
+
+        if frequencies != self._grid:
+            self._prepare(frequencies)
+
+        values = {}
+
+        for window, (first, last) in zip(self.windows, self._ranges):
+            window_levels = levels[first:last]
+
+            if not window_levels:
+                continue
+
+            peak = max(window_levels)
+            label = f'window="{window["name"]}"'
+            values[f'analyzer_peak_level_dbm{{{label}}}'] = peak
+            values[f'analyzer_peak_frequency_hz{{{label}}}'] = frequencies[first + window_levels.index(peak)]
+
+            # Sum of powers of points, not corrected for RBW
+            power = sum(10 ** (level / 10) for level in window_levels)
+            values[f'analyzer_channel_power_dbm{{{label}}}'] = 10 * math.log10(power)
+
+            histogram = self._histograms[window['name']]
+            bucket = bisect.bisect_left(self.buckets, peak)
+
+            with self._lock:
+                for index in range(bucket, len(self.buckets)):
+                    histogram[0][index] += 1
+
+                histogram[1] += 1
+                histogram[2] += peak
+
+        for frequency, index in zip(self.markers, self._marker_indices):
+            values[f'analyzer_marker_level_dbm{{marker="{frequency}"}}'] = levels[index]
+
+        with self._lock:
+            self._values = values
+            self._sweeps += 1
+            self._last_sweep = sweep.timestamp
+
+        return [sweep]
+
+    def render(self) -> str:
+        lines = []
+
+        def add(name: str, kind: str, help_text: str, samples: list):
+            lines.append(f'# HELP {name} {help_text}')
+            lines.append(f'# TYPE {name} {kind}')
+            lines.extend(f'{sample} {value}' for sample, value in samples)
+
+        with self._lock:
+            values = self._values
+
+            for name, help_text in (('analyzer_peak_level_dbm', 'Highest level in window'),
+                                    ('analyzer_peak_frequency_hz', 'Frequency of highest level in window'),
+                                    ('analyzer_channel_power_dbm', 'Total power of points in window'),
+                                    ('analyzer_marker_level_dbm', 'Level at marker frequency')):
+                samples = [(sample, value) for sample, value in values.items() if sample.startswith(name + '{')]
+
+                if samples:
+                    add(name, 'gauge', help_text, samples)
+
+            if self._histograms:
+                samples = []
+
+                for window, (counts, count, total) in self._histograms.items():
+                    label = f'window="{window}"'
+                    samples += [(f'analyzer_window_peak_dbm_bucket{{{label},le="{bound}"}}', counts[index])
+                                for index, bound in enumerate(self.buckets)]
+                    samples.append((f'analyzer_window_peak_dbm_bucket{{{label},le="+Inf"}}', count))
+                    samples.append((f'analyzer_window_peak_dbm_sum{{{label}}}', total))
+                    samples.append((f'analyzer_window_peak_dbm_count{{{label}}}', count))
+
+                add('analyzer_window_peak_dbm', 'histogram', 'Distribution of highest levels in windows', samples)
+
+            add('analyzer_sweeps_total', 'counter', 'Sweeps received', [('analyzer_sweeps_total', self._sweeps)])
+
+            if self._sweeps:
+                add('analyzer_last_sweep_timestamp_seconds', 'gauge', 'Start time of the last sweep',
+                    [('analyzer_last_sweep_timestamp_seconds', self._last_sweep)])
+
+        # Counters are only read, values may be one sweep apart
+        stages = self.pipeline.stages if self.pipeline else [self]
+        device = getattr(stages[0], 'device', None)
+
+        if device and hasattr(device, 'bytes_read'):
+            add('analyzer_device_commands_total', 'counter', 'Commands sent to device',
+                [('analyzer_device_commands_total', device.commands)])
+            add('analyzer_device_read_bytes_total', 'counter', 'Bytes received from device',
+                [('analyzer_device_read_bytes_total', device.bytes_read)])
+            add('analyzer_device_written_bytes_total', 'counter', 'Bytes sent to device',
+                [('analyzer_device_written_bytes_total', device.bytes_written)])
+
+        add('pipeline_stage_sweeps_total', 'counter', 'Sweeps passed to and from pipeline stage',
+            [(f'pipeline_stage_sweeps_total{{stage="{stage.name}",direction="{direction}"}}', count)
+             for stage in stages for direction, count in (('in', stage.metrics.items_in), ('out', stage.metrics.items_out))])
+        add('pipeline_stage_busy_seconds_total', 'counter', 'Time spent by pipeline stage in processing',
+            [(f'pipeline_stage_busy_seconds_total{{stage="{stage.name}"}}', stage.metrics.busy) for stage in stages])
+        add('pipeline_stage_latency_max_seconds', 'gauge', 'Longest time from sweep start to leaving pipeline stage',
+            [(f'pipeline_stage_latency_max_seconds{{stage="{stage.name}"}}', stage.metrics.max_latency) for stage in stages])
+
+        lines.append('')
+        return '\n'.join(lines)
+
+    def close(self):
+        self._server.shutdown()
+        self._server.server_close()
+
+    def _prepare(self, frequencies: list):
+        self._grid = frequencies
+        self._ranges = [(bisect.bisect_left(frequencies, window['start']), bisect.bisect_right(frequencies, window['stop']))
+                        for window in self.windows]
+
+        last = len(frequencies) - 1
+        self._marker_indices = []
+
+        for frequency in self.markers:
+            index = min(bisect.bisect_left(frequencies, frequency), last)
+
+            # Take the nearest point
+            if index and frequency - frequencies[index - 1] < frequencies[index] - frequency:
+                index -= 1
+
+            self._marker_indices.append(index)
+
+
+STAGE_TYPES = {
+    'serial': SerialSweepSource,
+    'librevna': LibreVNASource,
+    'csv-replay': CSVReplaySource,
+    'archive-replay': ArchiveSource,
+    'accumulate': AccumulateTransform,
+    'decimate': DecimateTransform,
+    'deembed': DeembedTransform,
+    'threshold': ThresholdDetector,
+    'cfar': CFARDetector,
+    'tracker': PeakTracker,
+    'csv': CSVSink,
+    'archive': ArchiveSink,
+    'websocket': WebSocketSink,
+    'prometheus': PrometheusSink,
+}
+
+
+class Pipeline:
+    def __init__(self, stages: list, queue_size: int = _DEFAULT_QUEUE_SIZE, batch_size: int = _DEFAULT_BATCH_SIZE):
+        if not stages or not isinstance(stages[0], Source):
+            raise RuntimeError('Pipeline must start with a source')
+
+        self.stages = stages
+        self.batch_size = batch_size
+
+        for stage in stages:
+            stage.pipeline = self
+
+        self.queues = [queue.Queue(queue_size) for _ in stages[1:]]
+
+        self._stop = threading.Event()
+        self._error = None  # first exception raised by stage
+
+    @staticmethod
+    def from_config(path: str) -> 'Pipeline':
+        with open(path, encoding='utf-8') as f:
+            config = json.load(f)
+
+        stages = []
+
+        for entry in config['stages']:
+            parameters = dict(entry)
+            stage_type = parameters.pop('type')
+
+            if stage_type not in STAGE_TYPES:
+                raise RuntimeError(f'Unknown stage type {stage_type}')
+
+            stages.append(STAGE_TYPES[stage_type](**parameters))
+
+        return Pipeline(stages, config.get('queue_size', _DEFAULT_QUEUE_SIZE),
+                        config.get('batch_size', _DEFAULT_BATCH_SIZE))
+
+    def run(self, report_interval: float = 0.0):
+        threads = [threading.Thread(target=self._run_source, daemon=True)]
+        threads += [threading.Thread(target=self._run_stage, args=(index,), daemon=True)
+                    for index in range(1, len(self.stages))]
+
+        for thread in threads:
+            thread.start()
+
+        try:
+            for thread in threads:
+                while thread.is_alive():
+                    thread.join(report_interval or None)
+
+                    if report_interval and thread.is_alive():
+                        print(self.report())
+        except KeyboardInterrupt:
+            # Source stops, and remaining sweeps go through all stages
+            self._stop.set()
+
+            for thread in threads:
+                thread.join()
+
+        if self._error:
+            raise RuntimeError(f'Pipeline failed: {self._error}') from self._error
+
+    def report(self) -> str:
+        lines = []
+
+        for index, stage in enumerate(self.stages):
+            queued = f', queue {self.queues[index - 1].qsize()}' if index else ''
+            lines.append(f'{stage.name}: {stage.metrics.report()}{queued}')
+
+        return '\n'.join(lines)
+
+    def _put(self, index: int, batch: list):
+        """Pass batch to stage of given index"""
+        if index < len(self.stages):
+            self.queues[index - 1].put(batch)
+
+    def _run_source(self):
+        source = self.stages[0]
+        metrics = source.metrics
+
+        try:
+            produced = source.produce(self._stop)
+
+            while True:
+                begin = time.monotonic()
+                sweep = next(produced, None)
+
+                if sweep is None:
+                    break
+
+                metrics.add_batch(1, [sweep], time.monotonic() - begin)
+                self._put(1, [sweep])
+        except Exception as ex:
+            self._fail(source, ex)
+        finally:
+            source.close()
+            self._put(1, None)
+
+    def _run_stage(self, index: int):
+        stage = self.stages[index]
+        metrics = stage.metrics
+        incoming = self.queues[index - 1]
+        finished = False
+
+        try:
+            while not finished:
+                batch = incoming.get()
+
+                if batch is None:
+                    break
+
+                # Take whatever else is waiting, to process it in one go
+                while len(batch) < self.batch_size:
+                    try:
+                        more = incoming.get_nowait()
+                    except queue.Empty:
+                        break
+
+                    if more is None:
+                        finished = True
+                        break
+
+                    batch += more
+
+                begin = time.monotonic()
+                outputs = []
+
+                for sweep in batch:
+                    outputs += stage.process(sweep)
+
+                metrics.add_batch(len(batch), outputs, time.monotonic() - begin)
+
+                if outputs:
+                    self._put(index + 1, outputs)
+        except Exception as ex:
+            self._fail(stage, ex)
+
+            # Keep upstream stages from blocking on full queue until they finish
+            while not finished and incoming.get() is not None:
+                pass
+        finally:
+            stage.close()
+            self._put(index + 1, None)
+
+    def _fail(self, stage: Stage, error: Exception):
+        """Stop source, so sweeps already taken go through and all stages finish"""
+        print(f'Stage {stage.name} failed: {error!r}', file=sys.stderr)
+
+        if not self._error:
+            self._error = error
+
+        self._stop.set()
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('config', metavar='json-file', help='pipeline configuration')
+    parser.add_argument('--metrics', type=float, default=0.0, metavar='seconds',
+                        help='report metrics of stages periodically')
+    args = parser.parse_args()
+
+    pipeline = Pipeline.from_config(args.config)
+    pipeline.run(args.metrics)
+
+    print(pipeline.report())
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Reads text from screen captures by matching glyphs of firmware's bitmap font
+#
+# Font is learned from sample captures with known text, e.g.
+#   readout.py --font font.json --learn markers "1: 92.00MHz -58.7dBm" capture.bmp
+# then text of all regions is read from bitmaps and capture files, one JSON line per frame
+#   readout.py --font font.json screens.cap
+#
+# Pixels of region are classified as text or background once per unique color. Lines and glyphs are
+# separated by empty rows and columns, found by regular expression over occupancy bytes. Glyph is looked up
+# as a whole by its pixels, unknown glyph is matched to template of the same size with the fewest different pixels.
+
+import argparse
+import json
+import re
+
+from bmpfile import BMPFile
+from capturefile import CaptureFile, EXTENSION as CAPTURE_EXTENSION, parse_range
+
+
+# Text regions of tinySA ULTRA screen, x, y, width and height
+DEFAULT_REGIONS = {
+    'markers': (0, 1, 480, 12),
+    'settings': (0, 14, 30, 212),
+}
+
+_OCCUPIED = re.compile(rb'[^\x00]+')
+
+_MIN_BRIGHTNESS = 96  # of the brightest RGB component of text pixel, grid and frames are darker
+_MAX_MISMATCH = 0.05  # part of glyph pixels that can differ from template, more confuses digits with letters
+_SPACE_WIDTH = 3  # columns between glyphs to insert space
+
+_MARKER = re.compile(r'(\d+):?\s*(-?[\d.]+)\s*([kMG]?)Hz\s+(-?[\d.]+)\s*dBm')
+_MULTIPLIERS = {'': 1, 'k': 1e3, 'M': 1e6, 'G': 1e9}
+
+
+class Screen:
+    """RGB565 pixels of a frame, e.g. from capture file or bitmap"""
+
+    def __init__(self, width: int, height: int, pixels, bottom_up: bool = False):
+        self.width = width
+        self.height = height
+        self.pixels = pixels
+        self.bottom_up = bottom_up
+
+    @staticmethod
+    def from_bmp(bmpfile: BMPFile) -> 'Screen':
+        height = abs(bmpfile.height)
+        return Screen(bmpfile.width, height, bmpfile.pixels, bmpfile.height > 0)
+
+    def row(self, y: int, x: int, width: int):
+        if self.bottom_up:
+            y = self.height - 1 - y
+
+        offset = y * self.width + x
+        return self.pixels[offset:offset + width]
+
+
+def _is_text(color: int) -> int:
+    red, green, blue = (color >> 8) & 0xf8, (color >> 3) & 0xfc, (color << 3) & 0xf8
+    return 1 if max(red, green, blue) >= _MIN_BRIGHTNESS else 0
+
+
+class Glyph:
+    __slots__ = ('rows', 'width')
+
+    def __init__(self, rows: tuple):
+        self.rows = rows  # bytes of zeros and ones per row
+        self.width = len(rows[0])
+
+    def key(self) -> tuple:
+        return self.rows
+
+    def bits(self) -> int:
+        return int.from_bytes(b''.join(self.rows), 'big')
+
+    def to_text(self) -> list:
+        return [row.decode('ascii').replace('\x00', '.').replace('\x01', '#') for row in self.rows]
+
+    @staticmethod
+    def from_text(lines: list) -> 'Glyph':
+        return Glyph(tuple(line.replace('.', '\x00').replace('#', '\x01').encode('ascii') for line in lines))
+
+
+class Font:
+    def __init__(self, path: str = None):
+        self.glyphs = {}  # character by glyph rows
+        self._templates = None  # glyph bits and character by size, built on first mismatch
+
+        if path:
+            with open(path, encoding='utf-8') as f:
+                for entry in json.load(f)['glyphs']:
+                    self.add(Glyph.from_text(entry['rows']), entry['char'])
+
+    def save(self, path: str):
+        glyphs = [{'char': char, 'rows': Glyph(rows).to_text()} for rows, char in self.glyphs.items()]
+
+        with open(path, 'w', encoding='utf-8') as f:
+            json.dump({'glyphs': glyphs}, f, indent=1)
+
+    def add(self, glyph: Glyph, char: str):
+        """Assign character to glyph, identical glyphs like O and 0 keep the last one"""
+        self.glyphs[glyph.key()] = char
+        self._templates = None
+
+    def match(self, glyph: Glyph) -> str:
+        char = self.glyphs.get(glyph.key())
+
+        if char is not None:
+            return char
+
+        # Differing pixels of all rows at once, every pixel is a byte of zero or one
+        if self._templates is None:
+            self._templates = {}
+
+            for rows, template_char in self.glyphs.items():
+                template = Glyph(rows)
+                size = (template.width, len(rows))
+                self._templates.setdefault(size, []).append((template.bits(), template_char))
+
+        bits = glyph.bits()
+        templates = self._templates.get((glyph.width, len(glyph.rows)), ())
+        best = min(templates, key=lambda template: (template[0] ^ bits).bit_count(), default=None)
+
+        if best and (best[0] ^ bits).bit_count() <= glyph.width * len(glyph.rows) * _MAX_MISMATCH:
+            return best[1]
+
+        return '?'
+
+    def learn(self, screen: Screen, region: tuple, text: str):
+        """Assign characters of text, lines separated by | and without spaces, to glyphs of region"""
+        lines = [line.replace(' ', '') for line in text.split('|')]
+        found = list(_lines(screen, region))
+
+        if len(found) != len(lines):
+            raise RuntimeError(f'Found {len(found)} line(s) of text instead of {len(lines)}')
+
+        for glyphs, line in zip(found, lines):
+            glyphs = [glyph for glyph in glyphs if glyph]  # skip spaces
+
+            if len(glyphs) != len(line):
+                raise RuntimeError(f'Found {len(glyphs)} glyph(s) instead of {len(line)} for "{line}"')
+
+            for glyph, char in zip(glyphs, line):
+                self.add(glyph, char)
+
+    def read(self, screen: Screen, region: tuple) -> list:
+        return [''.join(self.match(glyph) if glyph else ' ' for glyph in glyphs).strip()
+                for glyphs in _lines(screen, region)]
+
+
+def _lines(screen: Screen, region: tuple):
+    """Yield lists of glyphs in every line of region, None stands for space"""
+    x, y, width, height = region
+
+    # Text flags of all colors in region
+    flags = {}
+    rows = []
+
+    for row_y in range(y, y + height):
+        row = screen.row(row_y, x, width)
+
+        for color in set(row).difference(flags):
+            flags[color] = _is_text(color)
+
+        rows.append(bytes(map(flags.__getitem__, row)))
+
+    occupied_rows = bytes(1 if any(row) else 0 for row in rows)
+
+    for line in _OCCUPIED.finditer(occupied_rows):
+        line_rows = rows[line.start():line.end()]
+
+        # Columns with any text pixel
+        columns = int.from_bytes(line_rows[0], 'big')
+
+        for row in line_rows[1:]:
+            columns |= int.from_bytes(row, 'big')
+
+        glyphs = []
+        previous_end = None
+
+        for span in _OCCUPIED.finditer(columns.to_bytes(width, 'big')):
+            start, end = span.span()
+
+            if previous_end is not None and start - previous_end >= _SPACE_WIDTH:
+                glyphs.append(None)
+
+            glyphs.append(Glyph(tuple(row[start:end] for row in line_rows)))
+            previous_end = end
+
+        yield glyphs
+
+
+def parse_markers(lines: list) -> list:
+    """Extract number, frequency in Hz and level in dBm of markers"""
+    markers = []
+
+    for line in lines:
+        for match in _MARKER.finditer(line):
+            number, frequency, multiplier, level = match.groups()
+
+            try:
+                markers.append({'marker': int(number), 'frequency': round(float(frequency) * _MULTIPLIERS[multiplier]),
+                                'level': float(level)})
+            except ValueError:
+                pass  # misread digits
+
+    return markers
+
+
+def parse_settings(lines: list) -> dict:
+    """Pair lines of labels with lines of their values below them"""
+    settings = {}
+    label = None
+
+    for line in lines:
+        if label and any(char.isdigit() for char in line):
+            settings[label] = line
+            label = None
+        else:
+            label = line
+
+    return settings
+
+
+def read_screen(font: Font, screen: Screen, regions: dict) -> dict:
+    text = {name: font.read(screen, region) for name, region in regions.items()}
+    result = {'text': text}
+
+    if 'markers' in text:
+        result['markers'] = parse_markers(text['markers'])
+
+    if 'settings' in text:
+        result['settings'] = parse_settings(text['settings'])
+
+    return result
+
+
+def _screens(path: str, frames: str = None):
+    """Yield frame index, timestamp and screen of bitmap or frames of capture file"""
+    if path.endswith(CAPTURE_EXTENSION):
+        with CaptureFile(path) as capture:
+            for index in parse_range(frames, len(capture)):
+                pixels = memoryview(bytes(capture.pixels(index))).cast('H')  # not tied to mapping of file
+                yield index, capture.timestamp(index), Screen(capture.width, capture.height, pixels)
+    else:
+        yield 0, None, Screen.from_bmp(BMPFile(path))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('files', metavar='bmp-or-cap-file', type=str, nargs='+')
+    parser.add_argument('--font', required=True, metavar='json-file', help='glyphs of font, updated when learning')
+    parser.add_argument('--regions', metavar='json-file',
+                        help='text regions, name and list of x, y, width and height, tinySA ULTRA ones by default')
+    parser.add_argument('--learn', nargs=2, metavar=('region', 'text'),
+                        help='learn glyphs from text of region in the first frame, lines are separated by |')
+    parser.add_argument('--frames', help='read given frames of capture files only, N, N-M, N- or -M', metavar='range')
+    args = parser.parse_args()
+
+    regions = DEFAULT_REGIONS
+
+    if args.regions:
+        with open(args.regions, encoding='utf-8') as f:
+            regions = {name: tuple(region) for name, region in json.load(f).items()}
+
+    if args.learn:
+        try:
+            font = Font(args.font)
+        except FileNotFoundError:
+            font = Font()
+
+        name, text = args.learn
+
+        for path in args.files:
+            _, _, screen = next(_screens(path, args.frames))
+            font.learn(screen, regions[name], text)
+
+        font.save(args.font)
+        print(f'{len(font.glyphs)} glyph(s) in {args.font}')
+        return
+
+    font = Font(args.font)
+
+    for path in args.files:
+        for index, timestamp, screen in _screens(path, args.frames):
+            result = {'file': path, 'frame': index, 'timestamp': timestamp}
+            result.update(read_screen(font, screen, regions))
+            print(json.dumps(result))
+
+
+if '__main__' == __name__:
+    main()
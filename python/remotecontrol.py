@@ -18,17 +18,35 @@
 #
 
 import argparse
+import array
+import bisect
+import collections
+import contextlib
 import datetime
 import enum
+import functools
+import json
+import operator
+import os
+import re
 import struct
 import sys
+import threading
+import time
 
 import serial
 from serial.tools import list_ports
 
+import capturefile
+import deembed
+import tinysa4preset
+
 
 _DeviceType = enum.Enum('DeviceType', 'TINYSA4 NANOVNA_FVX TINYGTC')
 
+_CHUNK_SIZE = 64 * 1024
+_TRANSFER_TIMEOUT = 5.0  # seconds
+
 _BMP_HEADER1 = b'BMz\xb0\x04\x00\x00\x00\x00\x00z\x00\x00\x00l\x00\x00\x00'
 _BMP_HEADER2 = b'\x01'\
     b'\x00\x10\x00\x03\x00\x00\x00\x00\xb0\x04\x00\xc4\x0e\x00\x00\xc4\x0e\x00\x00\x00\x00\x00\x00'\
@@ -37,6 +55,60 @@ _BMP_HEADER2 = b'\x01'\
     b'\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00'
 
 
+class RemoteFileIndex:
+    """Files copied from SD cards of devices, to find ones that appeared since the last copy"""
+
+    DEFAULT_PATH = '.sd_index.json'
+
+    def __init__(self, path: str = DEFAULT_PATH):
+        self.path = path
+        self._lock = threading.Lock()
+        self._devices = {}
+
+        if os.path.exists(path):
+            with open(path, encoding='utf-8') as f:
+                self._devices = json.load(f)
+
+    def new_files(self, device: str, files: dict) -> dict:
+        """Return entries of name to size listing which are not copied yet, device is its identifier"""
+        with self._lock:
+            known = self._devices.get(device)
+
+            if not known:
+                return dict(files)
+
+            # Every file is checked on its own, so listings of different patterns don't affect each other
+            copied = known['files']
+            return {name: size for name, size in files.items() if copied.get(name) != size}
+
+    def add(self, device: str, name: str, size: int):
+        with self._lock:
+            known = self._devices.setdefault(device, {'files': {}})
+            known['files'][name] = size
+
+    def save(self):
+        with self._lock:
+            with open(self.path, 'w', encoding='utf-8') as f:
+                json.dump(self._devices, f, indent=1)
+
+
+def _exclusive(method):
+    """Run command with device locked, background SD card sync waits until it's completed"""
+    @functools.wraps(method)
+    def wrapper(self, *args, **kwargs):
+        with self._waiting_lock:
+            self._waiting += 1
+
+        try:
+            with self._lock:
+                return method(self, *args, **kwargs)
+        finally:
+            with self._waiting_lock:
+                self._waiting -= 1
+
+    return wrapper
+
+
 class SMTVirtualCOMPort:
     VID = 0x0483  # 1155
     PID_GENERIC = 0x5740  # 22336
@@ -49,10 +121,17 @@ class SMTVirtualCOMPort:
         self._device_type = None
         self._prompt = b'ch>'
         self.verbose = verbose
+        self._lock = threading.RLock()
+        self._waiting = 0  # number of commands waiting for device
+        self._waiting_lock = threading.Lock()
+        self.commands = 0
+        self.bytes_read = 0
+        self.bytes_written = 0
+        self.serial_number = None  # of USB device, to tell devices of the same model apart
+        tinygtc_port = None
 
         if not device_name:
             ports = list_ports.comports()
-            tinygtc_port = None
 
             for port in ports:
                 if port.vid != self.VID:
@@ -66,16 +145,24 @@ class SMTVirtualCOMPort:
                         tinygtc_port = port
                 elif port.pid == self.PID_GENERIC:
                     device_name = port.device
+                    self.serial_number = port.serial_number
+                    break
+        elif '://' not in device_name:
+            for port in list_ports.comports():
+                if port.device == device_name:
+                    self.serial_number = port.serial_number
                     break
 
         if is_tinygtc := tinygtc_port and self.is_tinygtc():
             device_name = tinygtc_port.device
+            self.serial_number = tinygtc_port.serial_number
             self._prompt = b'>'
 
         if not device_name:
             raise OSError('No devices found')
 
-        self._device = serial.Serial(device_name)
+        self.device_name = device_name  # port or URL
+        self._device = serial.serial_for_url(device_name)
 
         if not is_tinygtc:
             self.send('info')
@@ -104,6 +191,14 @@ class SMTVirtualCOMPort:
     def is_nanovna_fvx(self):
         return self._device_type == _DeviceType.NANOVNA_FVX
 
+    @property
+    def identifier(self) -> str:
+        """Model and USB serial number, the same for the device on any port
+
+        Without serial number, e.g. through a bridge URL, port or URL tells devices of the same model apart."""
+        model = self._device_type.name if self._device_type else 'UNKNOWN'
+        return f'{model}:{self.serial_number}' if self.serial_number else f'{model}@{self.device_name}'
+
     def send(self, command: str):
         device = self._device
         assert device
@@ -112,57 +207,47 @@ class SMTVirtualCOMPort:
             command += '\r'
 
         device.write(command.encode())
-        device.readline()  # discard empty line
+        echo = device.readline()  # discard empty line
+
+        self.commands += 1
+        self.bytes_written += len(command)
+        self.bytes_read += len(echo)
 
     def receive(self):
         device = self._device
         assert device
 
-        result = bytearray()
-        line = bytearray()
-
-        while True:
-            c = device.read()
-
-            if c == b'\r':
-                continue  # ignore CR
-
-            line += c
-
-            if c == b'\n':
-                result += line
-                line = bytearray()
-                continue
+        # stop on prompt, ignore CR
+        result = device.read_until(self._prompt)
+        self.bytes_read += len(result)
+        result = result.replace(b'\r', b'')
 
-            if line.endswith(self._prompt):
-                # stop on prompt
-                break
-
-        return result.decode()
+        # drop prompt line
+        return result[:result.rfind(b'\n') + 1].decode()
 
-    def capture(self, path: str) -> bool:
+    @_exclusive
+    def capture(self, path: str, count: int = 1, compress: bool = False) -> bool:
         verbose = self.verbose
-        is_tinydevice = self.is_tinydevice()
 
-        if is_tinydevice:
+        if self.is_tinydevice():
             width, height = 480, 320
         elif self.is_nanovna_fvx():
             width, height = 800, 480
         else:
             return False
 
-        if verbose:
-            print(f'Capturing {width}x{height} bitmap...')
+        if path.endswith(capturefile.EXTENSION):
+            with capturefile.CaptureFile(path, width, height, compress) as container:
+                for _ in range(count):
+                    timestamp = time.time()
+                    container.append(self._capture(width, height), timestamp)
 
-        self.send('capture')
+                if verbose:
+                    print(f'Saved {len(container)} capture(s) in total to {path}')
 
-        pixels_length = width * height * 2
-        pixels = self._device.read(pixels_length)
-
-        if is_tinydevice:
-            # Swap bytes in pixels
-            pixels = bytes(pixels[x ^ 1] for x in range(pixels_length))
+            return True
 
+        pixels = self._capture(width, height)
         path = self._prepare_filename(path, 'bmp')
 
         if verbose:
@@ -179,45 +264,47 @@ class SMTVirtualCOMPort:
 
         return True
 
-    def copy(self, pattern: str):
+    @_exclusive
+    def copy(self, pattern: str, index: RemoteFileIndex = None):
         verbose = self.verbose
 
         if verbose:
-            print(f'Copying files {pattern}...')
+            print(f'Copying {"new " if index else ""}files {pattern}...')
 
-        entries = self._list(pattern).splitlines()
+        files = self._list_files(pattern)
 
-        for entry in entries:
-            name, size = entry.split(' ')
+        if index:
+            files = index.new_files(self.identifier, files)
 
+        for name, size in files.items():
             if verbose:
-                print(f'Reading file {name} of {size} bytes...')
+                print(f'Copying file {name} of {size} bytes...')
 
-            content = self._read(name)
-            content_size = len(content)
+            progress = _CopyProgress(size) if verbose else None
 
-            if content_size != int(size):
-                raise RuntimeError(f'Inconsistent size of file {name}, {size} vs. {content_size}')
+            self._copy_file(name, size, name, progress)
 
-            if verbose:
-                print(f'Saving file {name}...')
-
-            with open(name, 'wb') as f:
-                f.write(content)
+            if index:
+                # Interrupted copy will be continued from this file next time
+                index.add(self.identifier, name, size)
+                index.save()
 
+    @_exclusive
     def delete(self, pattern: str):
         if self.verbose:
             print(f'Deleting files {pattern}...')
 
         self.send(f'sd_delete {pattern}')
 
+    @_exclusive
     def list(self, pattern: str):
         if self.verbose:
             print(f'Listing files {pattern}...')
 
         print(self._list(pattern))
 
-    def save_sNp(self, port: int, path: str):
+    @_exclusive
+    def save_sNp(self, port: int, path: str, deembedder: deembed.Deembedder = None):
         if self.verbose:
             print(f'Getting S{port + 1}P data...')
 
@@ -235,6 +322,18 @@ class SMTVirtualCOMPort:
         del frequencies[count]
         del values[count]
 
+        if deembedder:
+            points = [int(frequency) for frequency in frequencies]
+            values = [complex(*map(float, value.split())) for value in values]
+
+            # Only one path is measured, so transmission is not corrected for mismatch
+            if port == SMTVirtualCOMPort.S1P:
+                values = deembedder.reflection(points, values)
+            else:
+                values = deembedder.transmission(points, values)
+
+            values = [f'{value.real:.9e} {value.imag:.9e}' for value in values]
+
         path = self._prepare_filename(path, f's{port + 1}p')
 
         if self.verbose:
@@ -249,30 +348,159 @@ class SMTVirtualCOMPort:
                 f.write(entry[1])
                 f.write('\n')
 
+    @_exclusive
+    def scan(self, start: int, stop: int, points: int) -> tuple:
+        """Sweep given range, return lists of frequencies and levels"""
+        # Output mask 3 means frequency and measured level on every line
+        self.send(f'scan {start} {stop} {points} 3')
+
+        frequencies = []
+        levels = []
+
+        for line in self.receive().splitlines():
+            frequency, level = line.split()[:2]
+            frequencies.append(int(frequency))
+            levels.append(float(level))
+
+        return frequencies, levels
+
+    @_exclusive
+    def set_rbw(self, rbw: float):
+        """Set resolution bandwidth in kHz, zero for automatic selection"""
+        self.send(f'rbw {rbw:g}' if rbw else 'rbw auto')
+        self.receive()
+
+    @_exclusive
     def version(self):
         self.send('version')
         print(self.receive())
 
+    def _capture(self, width: int, height: int) -> array.array:
+        if self.verbose:
+            print(f'Capturing {width}x{height} bitmap...')
+
+        self.send('capture')
+
+        # Receive RGB565 pixels straight into preallocated buffer
+        pixels = array.array('H', [0]) * (width * height)
+        buffer = memoryview(pixels).cast('B')
+        size = len(buffer)
+        received = 0
+
+        device = self._device
+        timeout = device.timeout
+
+        # Report truncated screen instead of returning it with zero pixels
+        device.timeout = _TRANSFER_TIMEOUT
+
+        try:
+            while received < size:
+                count = device.readinto(buffer[received:])
+
+                if not count:
+                    raise RuntimeError(f'Timed out capturing screen, received {received} of {size} bytes')
+
+                received += count
+                self.bytes_read += count
+        finally:
+            device.timeout = timeout
+
+        if self.is_tinydevice():
+            # Swap bytes in pixels
+            pixels.byteswap()
+
+        return pixels
+
     def _list(self, pattern: str) -> str:
         self.send(f'sd_list {pattern}')
         return self.receive()
 
-    def _read(self, filename: str):
+    def _list_files(self, pattern: str) -> dict:
+        files = {}
+
+        for entry in self._list(pattern).splitlines():
+            name, size = entry.split(' ')
+            files[name] = int(size)
+
+        return files
+
+    @contextlib.contextmanager
+    def _idle(self):
+        """Lock device when no commands are waiting for it, to use it in background"""
+        while True:
+            with self._lock:
+                if not self._waiting:
+                    yield
+                    return
+
+            time.sleep(0.05)
+
+    def _read_to_file(self, filename: str, f, chunk_size: int = _CHUNK_SIZE, progress=None) -> int:
+        device = self._device
+        assert device
+
+        timeout = device.timeout
+
+        # Report truncated transfer instead of waiting for missing bytes forever
+        device.timeout = _TRANSFER_TIMEOUT
+
+        try:
+            size = self._read_header(filename)
+            remaining = size
+            buffer = memoryview(bytearray(chunk_size))
+
+            # File is received in chunks anyway, device cannot be interrupted while sending it
+            while remaining:
+                received = device.readinto(buffer[:min(remaining, chunk_size)])
+
+                if not received:
+                    break
+
+                f.write(buffer[:received])
+                remaining -= received
+                self.bytes_read += received
+
+                if progress:
+                    progress(received)
+        finally:
+            device.timeout = timeout
+
+        return size - remaining
+
+    def _copy_file(self, filename: str, size: int, path: str, progress=None, chunk_size: int = _CHUNK_SIZE):
+        partpath = path + '.part'
+
+        # Incomplete file is not visible under its name
+        with open(partpath, 'wb') as f:
+            received = self._read_to_file(filename, f, chunk_size, progress)
+
+        if received != size:
+            raise RuntimeError(f'Inconsistent size of file {filename}, {size} vs. {received}')
+
+        os.replace(partpath, path)
+
+    def _read_header(self, filename: str) -> int:
+        """Request file, return its size, content follows it"""
         self.send(f'sd_read {filename}')
 
         device = self._device
         assert device
 
         if self.is_tinygtc():
+            # Size is sent as decimal text line followed by prompt and space, content starts right after it
             size_or_error = self.receive()
 
             if size_or_error.startswith('err:'):
                 raise RuntimeError(f"Cannot read {filename} from SD card, error{size_or_error}")
 
+            if not re.fullmatch(r'\d+\n', size_or_error):
+                raise RuntimeError(f'Unexpected size of file {filename}, {size_or_error!r}')
+
             size = int(size_or_error)
+            separator = device.read(1)
 
-            # TODO: figure out why a whitespace appears after size
-            device.read(1)
+            if separator != b' ':
+                raise RuntimeError(f'Unexpected {separator!r} after size of file {filename} instead of space')
         else:
             size_binary = device.read(4)
 
@@ -280,15 +508,18 @@ class SMTVirtualCOMPort:
                 message = self.receive()
                 raise RuntimeError(f"Cannot read {filename} from SD card, error{message}")
 
+            if len(size_binary) != 4:
+                raise RuntimeError(f'Truncated size of file {filename}')
+
             size = struct.unpack('<1I', size_binary)[0]
 
-        return device.read(size)
+        return size
 
     def _prepare_filename(self, path: str, extension: str) -> str:
         if path == '*':
-            time = datetime.datetime.now().strftime('%y%m%d_%H%M%S')
+            time_text = datetime.datetime.now().strftime('%y%m%d_%H%M%S')
             prefix = self._filename_prefix()
-            return f'{prefix}_{time}.{extension}'
+            return f'{prefix}_{time_text}.{extension}'
 
         return path
 
@@ -303,15 +534,404 @@ class SMTVirtualCOMPort:
         raise RuntimeError('Invalid device type')
 
 
+class _CopyProgress:
+    """Prints bytes of file received so far on the same line"""
+
+    def __init__(self, size: int):
+        self.size = size
+        self.done = 0
+
+    def __call__(self, count: int):
+        self.done += count
+        print(f'\r{self.done}/{self.size} bytes', end='\n' if self.done == self.size else '', flush=True)
+
+
+class SyncProgress:
+    def __init__(self):
+        self.files_total = 0
+        self.files_done = 0
+        self.bytes_total = 0
+        self.bytes_done = 0
+        self.current = None  # name of file being copied
+
+    def __str__(self):
+        current = f', copying {self.current}' if self.current else ''
+        return f'{self.files_done}/{self.files_total} files, {self.bytes_done}/{self.bytes_total} bytes{current}'
+
+
+class SDCardSync(threading.Thread):
+    """Mirrors SD card to directory in background, yielding device to commands between files"""
+
+    DEFAULT_INTERVAL = 10.0
+    DEFAULT_CHUNK_SIZE = _CHUNK_SIZE
+
+    def __init__(self, device: SMTVirtualCOMPort, directory: str = '.', pattern: str = '*',
+                 interval: float = DEFAULT_INTERVAL, chunk_size: int = DEFAULT_CHUNK_SIZE):
+        super().__init__(daemon=True)
+
+        self.device = device
+        self.directory = directory
+        self.pattern = pattern
+        self.interval = interval
+        self.chunk_size = chunk_size
+        self.progress = SyncProgress()
+        self.index = RemoteFileIndex(os.path.join(directory, RemoteFileIndex.DEFAULT_PATH))
+
+        self._stop_event = threading.Event()
+
+    def stop(self):
+        self._stop_event.set()
+        self.join()
+
+    def run(self):
+        while not self._stop_event.is_set():
+            try:
+                self._sync()
+            except (OSError, RuntimeError, serial.SerialException) as ex:
+                print(f'SD card sync failed, {ex}')
+
+            self._stop_event.wait(self.interval)
+
+    def _sync(self):
+        device = self.device
+        identifier = device.identifier
+
+        with device._idle():
+            files = device._list_files(self.pattern)
+
+        files = self.index.new_files(identifier, files)
+
+        if not files:
+            return
+
+        progress = self.progress
+        progress.files_total += len(files)
+        progress.bytes_total += sum(files.values())
+
+        for name, size in files.items():
+            if self._stop_event.is_set():
+                break
+
+            with device._idle():
+                self._copy(name, size)
+
+            progress.files_done += 1
+            self.index.add(identifier, name, size)
+            self.index.save()
+
+    def _copy(self, name: str, size: int):
+        progress = self.progress
+        progress.current = name
+
+        if self.device.verbose:
+            print(f'Syncing file {name} of {size} bytes...')
+
+        def advance(count: int):
+            progress.bytes_done += count
+
+        try:
+            self.device._copy_file(name, size, os.path.join(self.directory, name), advance, self.chunk_size)
+        finally:
+            progress.current = None
+
+
+class SweepConfig:
+    def __init__(self, name: str, start: int, stop: int, points: int = 450, rbw: float = 0.0,
+                 interval: float = 10.0, priority: int = 0, sink=None):
+        self.name = name
+        self.start = start
+        self.stop = stop
+        self.points = points
+        self.rbw = rbw  # kHz, zero for automatic
+        self.interval = interval  # target revisit time in seconds
+        self.priority = priority
+        self.sink = sink or SweepCSVSink(f'{name}.csv')
+
+        self.last_time = None  # monotonic time of the last sweep
+        self.count = 0
+        self.total_revisit = 0.0
+        self.max_revisit = 0.0
+
+    @staticmethod
+    def from_dict(dictionary: dict) -> 'SweepConfig':
+        """Make sweep configuration from dictionary with either frequency range or path to preset"""
+        values = dict(dictionary)
+
+        if path := values.pop('preset', None):
+            preset = tinysa4preset.load(path)
+            values.setdefault('name', os.path.splitext(os.path.basename(path))[0])
+            values.setdefault('start', preset.frequency0)
+            values.setdefault('stop', preset.frequency1)
+            values.setdefault('points', preset.sweep_points)
+            values.setdefault('rbw', preset.rbw_x10 / 10)
+
+        if sink := values.pop('sink', None):
+            values['sink'] = SweepCSVSink(sink)
+
+        return SweepConfig(**values)
+
+    def next_time(self, now: float) -> float:
+        return now if self.last_time is None else self.last_time + self.interval
+
+    def add_sweep(self, timestamp: float):
+        if self.last_time is not None:
+            revisit = timestamp - self.last_time
+            self.total_revisit += revisit
+            self.max_revisit = max(self.max_revisit, revisit)
+
+        self.last_time = timestamp
+        self.count += 1
+
+    def report(self) -> str:
+        average = self.total_revisit / (self.count - 1) if self.count > 1 else 0.0
+        return f'{self.name}: {self.count} sweep(s), revisit target {self.interval:.1f} s,' \
+            f' average {average:.1f} s, worst {self.max_revisit:.1f} s'
+
+
+class SweepCSVSink:
+    """Appends sweeps to CSV file, one line of levels per sweep after line of frequencies"""
+
+    def __init__(self, path: str):
+        self.path = path
+
+    def __call__(self, config: SweepConfig, timestamp: float, frequencies: list, levels: list):
+        header = not os.path.exists(self.path)
+
+        with open(self.path, 'a', encoding='ascii') as f:
+            if header:
+                f.write(','.join(['time'] + [str(frequency) for frequency in frequencies]))
+                f.write('\n')
+
+            f.write(','.join([f'{timestamp:.3f}'] + [f'{level:.2f}' for level in levels]))
+            f.write('\n')
+
+
+class SweepScheduler:
+    """Time-slices device between sweep configurations according to their revisit intervals and priorities"""
+
+    def __init__(self, device: SMTVirtualCOMPort, configs: list):
+        if not device.is_tinysa_ultra():
+            raise RuntimeError('Sweep scheduling requires tinySA ULTRA')
+
+        self.device = device
+        self.configs = configs
+        self.reconfigurations = 0
+
+        self._rbw = None  # unknown until set
+
+    def run(self, duration: float = None):
+        stop_time = time.monotonic() + duration if duration else None
+
+        while not stop_time or time.monotonic() < stop_time:
+            config = self._next_config()
+
+            if config:
+                self._sweep(config)
+            else:
+                now = time.monotonic()
+                delay = min(entry.next_time(now) for entry in self.configs) - now
+
+                if stop_time:
+                    delay = min(delay, stop_time - time.monotonic())
+
+                time.sleep(max(delay, 0.0))
+
+    def report(self) -> str:
+        lines = [config.report() for config in self.configs]
+        lines.append(f'{self.reconfigurations} reconfiguration(s)')
+        return '\n'.join(lines)
+
+    def _next_config(self) -> SweepConfig:
+        now = time.monotonic()
+        due = [config for config in self.configs if config.next_time(now) <= now]
+
+        if not due:
+            return None
+
+        # Higher priority first, then one that needs no reconfiguration, then the most overdue
+        return min(due, key=lambda config: (-config.priority, config.rbw != self._rbw, config.next_time(now)))
+
+    def _sweep(self, config: SweepConfig):
+        device = self.device
+
+        if config.rbw != self._rbw:
+            device.set_rbw(config.rbw)
+            self._rbw = config.rbw
+            self.reconfigurations += 1
+
+        if device.verbose:
+            print(f'Sweeping {config.name}, {config.start}-{config.stop} Hz...')
+
+        # Schedule is kept in monotonic time, so changes of wall clock don't shift it
+        started = time.monotonic()
+        timestamp = time.time()
+        frequencies, levels = device.scan(config.start, config.stop, config.points)
+        config.add_sweep(started)
+        config.sink(config, timestamp, frequencies, levels)
+
+
+class SweepTrigger:
+    """Keeps recent sweeps, saves ones around a sweep that exceeds level or mask in frequency window"""
+
+    def __init__(self, device: SMTVirtualCOMPort, level: float = None, mask: list = None, window: tuple = None,
+                 pre: int = 5, post: int = 5, prefix: str = 'trigger'):
+        self.device = device
+        self.level = level
+        self.mask = sorted(mask) if mask else None  # list of frequency and level pairs
+        self.window = window  # frequency range to check, whole sweep if not set
+        self.post = post
+        self.prefix = prefix
+        self.events = 0
+
+        self._history = collections.deque(maxlen=pre + 1)  # pre-trigger sweeps and the current one
+        self._event = None  # sweeps of event being collected
+        self._event_name = None
+        self._remaining = 0  # post-trigger sweeps to collect
+        self._grid = None  # frequencies of sweeps
+        self._range = None  # indices of window in sweep
+        self._limits = None  # mask levels of window points
+
+    @staticmethod
+    def load_mask(path: str) -> list:
+        """Read mask from CSV file with frequency and level on every line"""
+        mask = []
+
+        with open(path, encoding='ascii') as f:
+            for line in f:
+                if line.strip():
+                    frequency, level = line.split(',')[:2]
+                    mask.append((float(frequency), float(level)))
+
+        return mask
+
+    def run(self, start: int, stop: int, points: int, duration: float = None):
+        stop_time = time.monotonic() + duration if duration else None
+
+        try:
+            while not stop_time or time.monotonic() < stop_time:
+                timestamp = time.time()
+                frequencies, levels = self.device.scan(start, stop, points)
+                self.add(timestamp, frequencies, levels)
+        finally:
+            # Keep event with post-trigger sweeps collected so far
+            if self._event is not None:
+                self._save()
+
+    def add(self, timestamp: float, frequencies: list, levels: list) -> bool:
+        """Process sweep, return True if it triggered"""
+        sweep = (timestamp, frequencies, levels)
+        self._history.append(sweep)
+
+        if self._event is not None:
+            self._event.append(sweep)
+            self._remaining -= 1
+
+            if not self._remaining:
+                self._save()
+
+        triggered = self._check(frequencies, levels)
+
+        if triggered and self._event is None:
+            self._start(timestamp)
+
+        return triggered
+
+    def _check(self, frequencies: list, levels: list) -> bool:
+        if frequencies != self._grid:
+            self._prepare(frequencies)
+
+        first, last = self._range
+        window = levels[first:last]
+
+        if not window:
+            return False
+
+        if self.level is not None and max(window) > self.level:
+            return True
+
+        return self._limits is not None and any(map(operator.gt, window, self._limits))
+
+    def _prepare(self, frequencies: list):
+        self._grid = frequencies
+
+        if self.window:
+            first = bisect.bisect_left(frequencies, self.window[0])
+            last = bisect.bisect_right(frequencies, self.window[1])
+        else:
+            first, last = 0, len(frequencies)
+
+        self._range = first, last
+        self._limits = [self._mask_level(frequency) for frequency in frequencies[first:last]] if self.mask else None
+
+    def _mask_level(self, frequency: float) -> float:
+        mask = self.mask
+        index = bisect.bisect_left(mask, (frequency,))
+
+        if index == 0:
+            return mask[0][1]
+        if index == len(mask):
+            return mask[-1][1]
+
+        (frequency0, level0), (frequency1, level1) = mask[index - 1], mask[index]
+        return level0 + (level1 - level0) * (frequency - frequency0) / (frequency1 - frequency0)
+
+    def _start(self, timestamp: float):
+        self.events += 1
+
+        time_text = datetime.datetime.fromtimestamp(timestamp).strftime('%y%m%d_%H%M%S_%f')[:-3]
+        self._event_name = f'{self.prefix}_{time_text}'
+        self._event = list(self._history)
+        self._remaining = self.post
+
+        if self.device.verbose:
+            print(f'Triggered {self._event_name}...')
+
+        # Screen shows triggering sweep now
+        self.device.capture(self._event_name + '.bmp')
+
+        if not self._remaining:
+            self._save()
+
+    def _save(self):
+        sink = SweepCSVSink(self._event_name + '.csv')
+
+        for timestamp, frequencies, levels in self._event:
+            sink(None, timestamp, frequencies, levels)
+
+        self._event = None
+
+
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument('-1', '--s1p', const='*', help='save S1P', metavar='s1p-file', nargs='?')
     parser.add_argument('-2', '--s2p', const='*', help='save S2P', metavar='s2p-file', nargs='?')
-    parser.add_argument('-C', '--capture', const='*', help='save screen to file', metavar='bmp-file', nargs='?')
+    parser.add_argument('--deembed', nargs='+', metavar='s2p-file',
+                        help='remove fixtures from saved S1P or S2P, left one and optional right one')
+    parser.add_argument('-C', '--capture', const='*', metavar='bmp-or-cap-file', nargs='?',
+                        help=f'save screen to file, or append it to capture file with {capturefile.EXTENSION} extension')
+    parser.add_argument('--count', type=int, default=1, help='number of screens to append to capture file')
+    parser.add_argument('--compress', action='store_true', help='compress screens appended to capture file')
     parser.add_argument('-D', '--delete', help='delete files from SD card', metavar='pattern')
     parser.add_argument('-X', '--copy', help='copy files from SD card', metavar='pattern')
+    parser.add_argument('-N', '--new', action='store_true', help='copy only files not copied before')
+    parser.add_argument('--index', default=RemoteFileIndex.DEFAULT_PATH, metavar='json-file',
+                        help=f'file with lists of copied files, {RemoteFileIndex.DEFAULT_PATH} by default')
+    parser.add_argument('-S', '--sync', help='mirror SD card to directory in background until interrupted', metavar='directory')
+    parser.add_argument('--sync-interval', type=float, default=SDCardSync.DEFAULT_INTERVAL, metavar='seconds',
+                        help=f'delay between SD card listings, {SDCardSync.DEFAULT_INTERVAL} by default')
+    parser.add_argument('--schedule', metavar='json-file',
+                        help='sweep list of configurations with revisit intervals and priorities until interrupted')
+    parser.add_argument('--duration', type=float, metavar='seconds', help='stop scheduled or triggered sweeps after given time')
+    parser.add_argument('--trigger', type=float, metavar='level',
+                        help='sweep continuously, save sweeps and screen when level is exceeded')
+    parser.add_argument('--trigger-mask', metavar='csv-file', help='trigger when levels exceed mask of frequency and level pairs')
+    parser.add_argument('--trigger-window', type=int, nargs=2, metavar=('start', 'stop'), help='check only given frequency range')
+    parser.add_argument('--trigger-sweeps', type=int, nargs=2, default=(5, 5), metavar=('pre', 'post'),
+                        help='number of sweeps to save before and after triggering one, 5 and 5 by default')
+    parser.add_argument('--sweep', type=int, nargs=3, default=(100000, 800000000, 450), metavar=('start', 'stop', 'points'),
+                        help='frequency range and points of triggered sweeps')
     parser.add_argument('-L', '--list', const='*', help='list files on SD card', metavar='pattern', nargs='?')
-    parser.add_argument('--device', help='specify device explicitly', metavar='device-name')
+    parser.add_argument('--device', help='specify device explicitly, or socket://<host>:<port> of serialbridge.py', metavar='device-name')
     parser.add_argument('--verbose', action='store_true', help='enable verbose output')
     parser.add_argument('--version', action='store_true', help='obtain device version information')
     args = parser.parse_args()
@@ -321,12 +941,17 @@ def main():
         return
 
     device = SMTVirtualCOMPort(args.device, args.verbose)
+    sync = None
+
+    if args.sync:
+        sync = SDCardSync(device, args.sync, interval=args.sync_interval)
+        sync.start()
 
     if args.capture:
-        device.capture(args.capture)
+        device.capture(args.capture, args.count, args.compress)
 
     if args.copy:
-        device.copy(args.copy)
+        device.copy(args.copy, RemoteFileIndex(args.index) if args.new else None)
 
     if args.delete:
         device.delete(args.delete)
@@ -334,15 +959,58 @@ def main():
     if args.list:
         device.list(args.list)
 
+    deembedder = None
+
+    if args.deembed:
+        if len(args.deembed) > 2:
+            parser.error('at most two fixtures can be de-embedded')
+
+        deembedder = deembed.Deembedder(*args.deembed)
+
     if args.s1p:
-        device.save_sNp(SMTVirtualCOMPort.S1P, args.s1p)
+        device.save_sNp(SMTVirtualCOMPort.S1P, args.s1p, deembedder)
 
     if args.s2p:
-        device.save_sNp(SMTVirtualCOMPort.S2P, args.s2p)
+        device.save_sNp(SMTVirtualCOMPort.S2P, args.s2p, deembedder)
 
     if args.version:
         device.version()
 
+    if args.schedule:
+        with open(args.schedule, encoding='utf-8') as f:
+            configs = [SweepConfig.from_dict(entry) for entry in json.load(f)]
+
+        scheduler = SweepScheduler(device, configs)
+
+        try:
+            scheduler.run(args.duration)
+        except KeyboardInterrupt:
+            pass
+
+        print(scheduler.report())
+
+    if args.trigger is not None or args.trigger_mask:
+        mask = SweepTrigger.load_mask(args.trigger_mask) if args.trigger_mask else None
+        pre, post = args.trigger_sweeps
+        trigger = SweepTrigger(device, args.trigger, mask, args.trigger_window, pre, post)
+
+        try:
+            trigger.run(*args.sweep, args.duration)
+        except KeyboardInterrupt:
+            pass
+
+        print(f'{trigger.events} trigger event(s)')
+
+    if sync:
+        try:
+            while sync.is_alive():
+                sync.join(args.sync_interval)
+
+                if args.verbose:
+                    print(f'SD card sync: {sync.progress}')
+        except KeyboardInterrupt:
+            sync.stop()
+
 
 if '__main__' == __name__:
     main()
@@ -599,7 +599,7 @@ class Serial(SerialBase):
         """Return the number of bytes currently in the input buffer."""
         if not self.is_open:
             raise PortNotOpenError()
-        return self._read_buffer.qsize()
+        return len(self._read_ahead) + self._read_buffer.qsize()
 
     def read(self, size=1):
         """\
@@ -609,7 +609,7 @@ class Serial(SerialBase):
         """
         if not self.is_open:
             raise PortNotOpenError()
-        data = bytearray()
+        data = self._take_read_ahead(size)
         try:
             timeout = Timeout(self._timeout)
             while len(data) < size:
@@ -646,6 +646,7 @@ class Serial(SerialBase):
             raise PortNotOpenError()
         self.rfc2217_send_purge(PURGE_RECEIVE_BUFFER)
         # empty read buffer
+        del self._read_ahead[:]
         while self._read_buffer.qsize():
             self._read_buffer.get(False)
 
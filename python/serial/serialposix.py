@@ -38,8 +38,16 @@ import sys
 import termios
 
 import serial
-from serial.serialutil import SerialBase, SerialException, to_bytes, \
-    PortNotOpenError, SerialTimeoutException, Timeout
+from serial.serialutil import SerialBase, SerialException, \
+    to_memoryview, advance_views, PortNotOpenError, SerialTimeoutException, Timeout
+
+# maximum number of buffers passed to a single writev() call
+try:
+    IOV_MAX = os.sysconf('SC_IOV_MAX')
+except (AttributeError, ValueError, OSError):
+    IOV_MAX = 16
+if IOV_MAX <= 0:
+    IOV_MAX = 16
 
 
 class PlatformSpecificBase(object):
@@ -547,7 +555,7 @@ class Serial(SerialBase, PlatformSpecific):
         """Return the number of bytes currently in the input buffer."""
         #~ s = fcntl.ioctl(self.fd, termios.FIONREAD, TIOCM_zero_str)
         s = fcntl.ioctl(self.fd, TIOCINQ, TIOCM_zero_str)
-        return struct.unpack('I', s)[0]
+        return len(self._read_ahead) + struct.unpack('I', s)[0]
 
     # select based implementation, proved to work on many systems
     def read(self, size=1):
@@ -558,7 +566,7 @@ class Serial(SerialBase, PlatformSpecific):
         """
         if not self.is_open:
             raise PortNotOpenError()
-        read = bytearray()
+        read = self._take_read_ahead(size)
         timeout = Timeout(self._timeout)
         while len(read) < size:
             try:
@@ -601,6 +609,42 @@ class Serial(SerialBase, PlatformSpecific):
                 break
         return bytes(read)
 
+    def readinto(self, b):
+        """\
+        Read up to len(b) bytes directly into the writable buffer b, return
+        the number of bytes read. Timeout handling is the same as in read(),
+        but no intermediate bytes objects are created.
+        """
+        if not self.is_open:
+            raise PortNotOpenError()
+        view = memoryview(b).cast('B')
+        size = len(view)
+        read = self._take_read_ahead_into(view)
+        timeout = Timeout(self._timeout)
+        while read < size:
+            try:
+                ready, _, _ = select.select([self.fd, self.pipe_abort_read_r], [], [], timeout.time_left())
+                if self.pipe_abort_read_r in ready:
+                    os.read(self.pipe_abort_read_r, 1000)
+                    break
+                if not ready:
+                    break   # timeout
+                n = os.readv(self.fd, [view[read:]])
+            except OSError as e:
+                # ignore BlockingIOErrors and EINTR. other errors are shown
+                if e.errno not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
+                    raise SerialException('read failed: {}'.format(e))
+            else:
+                if not n:
+                    raise SerialException(
+                        'device reports readiness to read but returned no data '
+                        '(device disconnected or multiple access on port?)')
+                read += n
+
+            if timeout.expired():
+                break
+        return read
+
     def cancel_read(self):
         if self.is_open:
             os.write(self.pipe_abort_read_w, b"x")
@@ -611,57 +655,54 @@ class Serial(SerialBase, PlatformSpecific):
 
     def write(self, data):
         """Output the given byte string over the serial port."""
+        return self._write_views([to_memoryview(data)])
+
+    def writelines(self, lines):
+        """\
+        Output a sequence of byte strings, e.g. a header followed by a
+        payload, with scatter-gather writes instead of joining them first.
+        """
+        self._write_views([to_memoryview(line) for line in lines])
+
+    def _write_views(self, views):
+        """\
+        Write a list of byte memoryviews with writev(). Partial writes only
+        advance the views, so large buffers are not copied over and over,
+        and select() is used only when the device is not ready for more.
+        """
         if not self.is_open:
             raise PortNotOpenError()
-        d = to_bytes(data)
-        tx_len = length = len(d)
+        views = [view for view in views if len(view)]
+        written = 0
         timeout = Timeout(self._write_timeout)
-        while tx_len > 0:
+        while views:
             try:
-                n = os.write(self.fd, d)
-                if timeout.is_non_blocking:
-                    # Zero timeout indicates non-blocking - simply return the
-                    # number of bytes of data actually written
-                    return n
-                elif not timeout.is_infinite:
-                    # when timeout is set, use select to wait for being ready
-                    # with the time left as timeout
-                    if timeout.expired():
-                        raise SerialTimeoutException('Write timeout')
-                    abort, ready, _ = select.select([self.pipe_abort_write_r], [self.fd], [], timeout.time_left())
-                    if abort:
-                        os.read(self.pipe_abort_write_r, 1000)
-                        break
-                    if not ready:
-                        raise SerialTimeoutException('Write timeout')
-                else:
-                    assert timeout.time_left() is None
-                    # wait for write operation
-                    abort, ready, _ = select.select([self.pipe_abort_write_r], [self.fd], [], None)
-                    if abort:
-                        os.read(self.pipe_abort_write_r, 1)
-                        break
-                    if not ready:
-                        raise SerialException('write failed (select)')
-                d = d[n:]
-                tx_len -= n
-            except SerialException:
-                raise
+                n = os.writev(self.fd, views[:IOV_MAX])
             except OSError as e:
-                # this is for Python 3.x where select.error is a subclass of
-                # OSError ignore BlockingIOErrors and EINTR. other errors are shown
-                # https://www.python.org/dev/peps/pep-0475.
+                # ignore BlockingIOErrors and EINTR, wait below. other errors are shown
                 if e.errno not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
                     raise SerialException('write failed: {}'.format(e))
-            except select.error as e:
-                # this is for Python 2.x
-                # ignore BlockingIOErrors and EINTR. all errors are shown
-                # see also http://www.python.org/dev/peps/pep-3151/#select
-                if e[0] not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
-                    raise SerialException('write failed: {}'.format(e))
-            if not timeout.is_non_blocking and timeout.expired():
+                n = 0
+            written += n
+            if timeout.is_non_blocking:
+                # Zero timeout indicates non-blocking - simply return the
+                # number of bytes of data actually written
+                return written
+            advance_views(views, n)
+            if not views:
+                break
+            if timeout.expired():
+                raise SerialTimeoutException('Write timeout')
+            # wait until device is ready for more, with the time left as timeout
+            abort, ready, _ = select.select([self.pipe_abort_write_r], [self.fd], [], timeout.time_left())
+            if abort:
+                os.read(self.pipe_abort_write_r, 1000)
+                break
+            if not ready:
+                if timeout.is_infinite:
+                    raise SerialException('write failed (select)')
                 raise SerialTimeoutException('Write timeout')
-        return length - len(d)
+        return written
 
     def flush(self):
         """\
@@ -674,6 +715,7 @@ class Serial(SerialBase, PlatformSpecific):
 
     def _reset_input_buffer(self):
         """Clear input buffer, discarding all that is in the buffer."""
+        del self._read_ahead[:]
         termios.tcflush(self.fd, termios.TCIFLUSH)
 
     def reset_input_buffer(self):
@@ -811,7 +853,7 @@ class PosixPollSerial(Serial):
         """
         if not self.is_open:
             raise PortNotOpenError()
-        read = bytearray()
+        read = self._take_read_ahead(size)
         timeout = Timeout(self._timeout)
         poll = select.poll()
         poll.register(self.fd, select.POLLIN | select.POLLERR | select.POLLHUP | select.POLLNVAL)
@@ -837,6 +879,42 @@ class PosixPollSerial(Serial):
                     break   # early abort on timeout
         return bytes(read)
 
+    def readinto(self, b):
+        """\
+        Read up to len(b) bytes directly into the writable buffer b, return
+        the number of bytes read. Waiting, abort and error handling are the
+        same as in read().
+        """
+        if not self.is_open:
+            raise PortNotOpenError()
+        view = memoryview(b).cast('B')
+        size = len(view)
+        read = self._take_read_ahead_into(view)
+        timeout = Timeout(self._timeout)
+        poll = select.poll()
+        poll.register(self.fd, select.POLLIN | select.POLLERR | select.POLLHUP | select.POLLNVAL)
+        poll.register(self.pipe_abort_read_r, select.POLLIN | select.POLLERR | select.POLLHUP | select.POLLNVAL)
+        while read < size:
+            events = poll.poll(None if timeout.is_infinite else (timeout.time_left() * 1000))
+            if any(fd == self.pipe_abort_read_r for fd, _ in events):
+                os.read(self.pipe_abort_read_r, 1000)
+                break
+            if any(event & (select.POLLERR | select.POLLHUP | select.POLLNVAL) for _, event in events):
+                raise SerialException('device reports error (poll)')
+            n = 0
+            if events:
+                try:
+                    n = os.readv(self.fd, [view[read:]])
+                except OSError as e:
+                    # ignore BlockingIOErrors and EINTR. other errors are shown
+                    if e.errno not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
+                        raise SerialException('read failed: {}'.format(e))
+                read += n
+            if timeout.expired() \
+                    or (self._inter_byte_timeout is not None and self._inter_byte_timeout > 0) and not n:
+                break   # early abort on timeout
+        return read
+
 
 class VTIMESerial(Serial):
     """\
@@ -888,7 +966,7 @@ class VTIMESerial(Serial):
         """
         if not self.is_open:
             raise PortNotOpenError()
-        read = bytearray()
+        read = self._take_read_ahead(size)
         while len(read) < size:
             buf = os.read(self.fd, size - len(read))
             if not buf:
@@ -896,5 +974,22 @@ class VTIMESerial(Serial):
             read.extend(buf)
         return bytes(read)
 
+    def readinto(self, b):
+        """\
+        Read up to len(b) bytes directly into the writable buffer b, return
+        the number of bytes read.
+        """
+        if not self.is_open:
+            raise PortNotOpenError()
+        view = memoryview(b).cast('B')
+        size = len(view)
+        read = self._take_read_ahead_into(view)
+        while read < size:
+            n = os.readv(self.fd, [view[read:]])
+            if not n:
+                break
+            read += n
+        return read
+
     # hack to make hasattr return false
     cancel_read = property()
@@ -68,6 +68,29 @@ def to_bytes(seq):
         return bytes(bytearray(seq))
 
 
+def to_memoryview(seq):
+    """convert a sequence to a flat byte memoryview, bytes-like objects are not copied"""
+    try:
+        return memoryview(seq).cast('B')
+    except TypeError:
+        return memoryview(to_bytes(seq))
+
+
+def advance_views(views, n):
+    """\
+    Drop the first n bytes from a list of byte memoryviews in place, as
+    after a partial scatter-gather write. Only the views are sliced, the
+    underlying data is never copied.
+    """
+    done = 0
+    while done < len(views) and n >= len(views[done]):
+        n -= len(views[done])
+        done += 1
+    del views[:done]
+    if views and n:
+        views[0] = views[0][n:]
+
+
 # create control bytes
 XON = to_bytes([17])
 XOFF = to_bytes([19])
@@ -217,6 +240,8 @@ class SerialBase(io.RawIOBase):
         self._dtr_state = True
         self._break_state = False
         self._exclusive = None
+        # bytes received ahead of a terminator by read_until(), served first by read()
+        self._read_ahead = bytearray()
 
         # assign values using get/set methods using the properties feature
         self.port = port
@@ -545,6 +570,9 @@ class SerialBase(io.RawIOBase):
     def seekable(self):
         return False
 
+    def readline(self, size=-1):
+        return self.read_until(LF, None if size is None or size < 0 else size)
+
     def readinto(self, b):
         data = self.read(len(b))
         n = len(data)
@@ -654,25 +682,57 @@ class SerialBase(io.RawIOBase):
     def read_until(self, expected=LF, size=None):
         """\
         Read until an expected sequence is found ('\n' by default), the size
-        is exceeded or until timeout occurs.
+        is exceeded or until timeout occurs. Data is fetched in chunks of
+        whatever is waiting, bytes past the expected sequence are kept for
+        the next read call.
         """
         lenterm = len(expected)
-        line = bytearray()
+        line = self._read_ahead
+        self._read_ahead = bytearray()
         timeout = Timeout(self._timeout)
+        expired = False
+        start = 0
         while True:
-            c = self.read(1)
-            if c:
-                line += c
-                if line[-lenterm:] == expected:
-                    break
-                if size is not None and len(line) >= size:
-                    break
-            else:
+            index = line.find(expected, start)
+            if index != -1:
+                end = index + lenterm
                 break
-            if timeout.expired():
+            if (size is not None and len(line) >= size) or expired:
+                end = len(line)
                 break
+            # terminator may be split between chunks
+            start = max(0, len(line) - lenterm + 1)
+            c = self.read(max(1, self.in_waiting))
+            if not c:
+                end = len(line)
+                break
+            line += c
+            expired = timeout.expired()
+        if size is not None:
+            end = min(end, size)
+        self._read_ahead = line[end:]
+        del line[end:]
         return bytes(line)
 
+    def _take_read_ahead_into(self, view):
+        """\
+        Move up to len(view) bytes buffered by read_until() into the start
+        of memoryview view, return the number of bytes moved.
+        """
+        n = min(len(view), len(self._read_ahead))
+        view[:n] = self._read_ahead[:n]
+        del self._read_ahead[:n]
+        return n
+
+    def _take_read_ahead(self, size):
+        """\
+        Remove and return up to size bytes buffered by read_until(). Backends
+        start their read() with it, so buffered data is served in order.
+        """
+        data = self._read_ahead[:size]
+        del self._read_ahead[:size]
+        return data
+
     def iread_until(self, *args, **kwargs):
         """\
         Read lines, implemented as generator. It will raise StopIteration on
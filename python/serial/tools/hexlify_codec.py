@@ -20,6 +20,7 @@ Therefore decoding is binary to text and thus converting binary data to hex dump
 
 from __future__ import absolute_import
 
+import binascii
 import codecs
 import serial
 
@@ -33,6 +34,13 @@ except (NameError, AttributeError):
 HEXDIGITS = '0123456789ABCDEF'
 
 
+def hexlify(data):
+    """b'@ab' -> '40 41 42 ', formatted in one pass instead of per byte"""
+    if not data:
+        return unicode('')
+    return unicode(binascii.hexlify(bytes(data), b' ').upper().decode('ascii') + ' ')
+
+
 # Codec APIs
 
 def hex_encode(data, errors='strict'):
@@ -42,7 +50,7 @@ def hex_encode(data, errors='strict'):
 
 def hex_decode(data, errors='strict'):
     """b'@ab' -> '40 41 42'"""
-    return (unicode(''.join('{:02X} '.format(ord(b)) for b in serial.iterbytes(data))), len(data))
+    return (hexlify(data), len(data))
 
 
 class Codec(codecs.Codec):
@@ -52,7 +60,7 @@ class Codec(codecs.Codec):
 
     def decode(self, data, errors='strict'):
         """b'@ab' -> '40 41 42'"""
-        return unicode(''.join('{:02X} '.format(ord(b)) for b in serial.iterbytes(data)))
+        return hexlify(data)
 
 
 class IncrementalEncoder(codecs.IncrementalEncoder):
@@ -101,7 +109,7 @@ class IncrementalEncoder(codecs.IncrementalEncoder):
 class IncrementalDecoder(codecs.IncrementalDecoder):
     """Incremental decoder"""
     def decode(self, data, final=False):
-        return unicode(''.join('{:02X} '.format(ord(b)) for b in serial.iterbytes(data)))
+        return hexlify(data)
 
 
 class StreamWriter(Codec, codecs.StreamWriter):
@@ -13,6 +13,7 @@ import codecs
 import os
 import sys
 import threading
+import time
 
 import serial
 from serial.tools.list_ports import comports
@@ -359,6 +360,163 @@ TRANSFORMATIONS = {
 }
 
 
+# - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+# bytes that are usual in terminal text, everything else counts as binary
+TEXT_BYTES = bytes(bytearray(range(0x20, 0x7f))) + b'\r\n\t\b\x1b'
+
+
+def is_binary(data, minimum=32):
+    """guess whether a received chunk is bulk binary data, e.g. a screen capture"""
+    if len(data) < minimum:
+        return False
+    # translate() deletes all text bytes in one pass, without per-character Python code
+    return len(data.translate(None, TEXT_BYTES)) * 8 > len(data)
+
+
+class BinaryDiverter(object):
+    """\
+    Detect bulk binary responses in received data and divert them to files
+    or to a one line hex summary instead of passing them through the text
+    transformations. A binary response ends with the device prompt.
+    """
+
+    def __init__(self, mode='hex', directory='.', prompt=b'ch> '):
+        self.mode = mode
+        self.directory = directory
+        self.prompt = prompt
+        self.lock = threading.Lock()
+        self._count = 0
+        self._index = 0
+        self._start = None
+        self._head = b''
+        self._pending = b''  # trailing bytes that may be the start of prompt
+        self._file = None
+        self._filename = None
+
+    def rx(self, data):
+        """return the part of received data that should be displayed as text"""
+        with self.lock:
+            if self._start is None:
+                if not is_binary(data):
+                    return data
+                # keep leading text, like the echo of the command
+                text_end = data.find(b'\n') + 1
+                if text_end and is_binary(data[:text_end], 1):
+                    text_end = 0
+                self._begin()
+                return data[:text_end] + self._append(data[text_end:])
+            return self._append(data)
+
+    def finish(self):
+        """end pending binary response, e.g. when a new command is sent"""
+        with self.lock:
+            if self._start is not None:
+                self._end()
+
+    def _begin(self):
+        self._start = time.time()
+        self._count = 0
+        self._head = b''
+        self._pending = b''
+        if self.mode == 'file':
+            self._index += 1
+            self._filename = os.path.join(
+                self.directory, 'rx_{}_{}.bin'.format(time.strftime('%y%m%d_%H%M%S'), self._index))
+            self._file = open(self._filename, 'wb')
+
+    def _append(self, data):
+        data = self._pending + data
+        if data.endswith(self.prompt):
+            # prompt is shown as text
+            self._store(data[:-len(self.prompt)])
+            self._pending = b''
+            self._end()
+            return self.prompt
+        # the prompt may be split between chunks, so its possible start waits for the next one
+        split = max(len(data) - len(self.prompt) + 1, 0)
+        self._store(data[:split])
+        self._pending = data[split:]
+        return b''
+
+    def _store(self, data):
+        if data:
+            if len(self._head) < 16:
+                self._head += data[:16 - len(self._head)]
+            if self._file:
+                self._file.write(data)
+            self._count += len(data)
+
+    def _end(self):
+        # bytes held back were not the prompt
+        self._store(self._pending)
+        self._pending = b''
+        duration = max(time.time() - self._start, 1e-6)
+        destination = ' -> {}'.format(self._filename) if self._file else ''
+        if self._file:
+            self._file.close()
+            self._file = None
+        sys.stderr.write('\n--- binary: {} bytes in {:.3f} s, {:.1f} KiB/s, [{}]{} ---\n'.format(
+            self._count, duration, self._count / duration / 1024,
+            ' '.join('{:02X}'.format(b) for b in bytearray(self._head)), destination))
+        self._start = None
+
+
+class TrafficStats(object):
+    """\
+    Count transmitted and received bytes, measure latency of commands, i.e.
+    time from ENTER to the first received byte and to the device prompt.
+    """
+
+    def __init__(self, prompt=b'ch> '):
+        self.prompt = prompt
+        self.lock = threading.Lock()
+        self.rx_bytes = 0
+        self.tx_bytes = 0
+        self._last_time = time.time()
+        self._last_rx = 0
+        self._last_tx = 0
+        self._command_time = None
+        self._first_byte = None
+        self._tail = b''
+        self.latency = None     # (first byte, prompt) in seconds of the last command
+
+    def tx(self, data):
+        with self.lock:
+            self.tx_bytes += len(data)
+            if b'\r' in data or b'\n' in data:
+                self._command_time = time.time()
+                self._first_byte = None
+
+    def rx(self, data):
+        with self.lock:
+            self.rx_bytes += len(data)
+            if self._command_time is None:
+                return
+            now = time.time()
+            if self._first_byte is None:
+                self._first_byte = now - self._command_time
+            self._tail = (self._tail + data[-len(self.prompt):])[-len(self.prompt):]
+            if self._tail == self.prompt:
+                self.latency = (self._first_byte, now - self._command_time)
+                self._command_time = None
+
+    def status(self):
+        """return status line with rates since previous call, None if there was no traffic"""
+        with self.lock:
+            now = time.time()
+            interval = max(now - self._last_time, 1e-6)
+            rx, tx = self.rx_bytes - self._last_rx, self.tx_bytes - self._last_tx
+            self._last_time, self._last_rx, self._last_tx = now, self.rx_bytes, self.tx_bytes
+            if not rx and not tx:
+                return None
+            line = '--- RX: {:.1f} KiB/s ({} total)  TX: {:.1f} KiB/s ({} total)'.format(
+                rx / interval / 1024, self.rx_bytes, tx / interval / 1024, self.tx_bytes)
+            if self.latency:
+                line += '  last command: first byte {:.1f} ms, prompt {:.1f} ms'.format(
+                    self.latency[0] * 1000, self.latency[1] * 1000)
+            return line + ' ---\n'
+
+
 # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 def ask_for_port():
     """\
@@ -408,6 +566,9 @@ class Miniterm(object):
         self.receiver_thread = None
         self.rx_decoder = None
         self.tx_decoder = None
+        self.diverter = None        # BinaryDiverter
+        self.stats = None           # TrafficStats
+        self.stats_interval = 1.0
 
     def _start_reader(self):
         """Start reader thread"""
@@ -432,6 +593,10 @@ class Miniterm(object):
         self.transmitter_thread = threading.Thread(target=self.writer, name='tx')
         self.transmitter_thread.daemon = True
         self.transmitter_thread.start()
+        if self.stats:
+            status_thread = threading.Thread(target=self.status, name='status')
+            status_thread.daemon = True
+            status_thread.start()
         self.console.setup()
 
     def stop(self):
@@ -497,6 +662,10 @@ class Miniterm(object):
             while self.alive and self._reader_alive:
                 # read all that is there or wait for one byte
                 data = self.serial.read(self.serial.in_waiting or 1)
+                if data and self.stats:
+                    self.stats.rx(data)
+                if data and self.diverter:
+                    data = self.diverter.rx(data)
                 if data:
                     if self.raw:
                         self.console.write_bytes(data)
@@ -538,7 +707,7 @@ class Miniterm(object):
                     text = c
                     for transformation in self.tx_transformations:
                         text = transformation.tx(text)
-                    self.serial.write(self.tx_encoder.encode(text))
+                    self.send(self.tx_encoder.encode(text))
                     if self.echo:
                         echo_text = c
                         for transformation in self.tx_transformations:
@@ -548,6 +717,23 @@ class Miniterm(object):
             self.alive = False
             raise
 
+    def send(self, data):
+        """write to serial port, update statistics and end pending binary response"""
+        if self.diverter:
+            self.diverter.finish()
+        if self.stats:
+            self.stats.tx(data)
+        self.serial.write(data)
+
+    def status(self):
+        """loop and show traffic statistics"""
+        while self.alive:
+            time.sleep(self.stats_interval)
+            line = self.stats.status()
+            if line:
+                sys.stderr.write(line)
+                sys.stderr.flush()
+
     def handle_menu_key(self, c):
         """Implement a simple menu / settings"""
         if c == self.menu_character or c == self.exit_character:
@@ -912,6 +1098,23 @@ def main(default_port=None, default_baudrate=9600, default_rts=None, default_dtr
         help='Do no apply any encodings/transformations',
         default=False)
 
+    group.add_argument(
+        '--binary',
+        choices=['hex', 'file'],
+        help='divert bulk binary responses to a hex summary or to files instead of the console')
+
+    group.add_argument(
+        '--binary-dir',
+        metavar='DIR',
+        help='directory for files with binary responses, default: %(default)s',
+        default='.')
+
+    group.add_argument(
+        '--prompt',
+        metavar='TEXT',
+        help='device prompt that ends a response, default: %(default)r',
+        default='ch> ')
+
     group = parser.add_argument_group('hotkeys')
 
     group.add_argument(
@@ -942,6 +1145,14 @@ def main(default_port=None, default_baudrate=9600, default_rts=None, default_dtr
         help='show Python traceback on error',
         default=False)
 
+    group.add_argument(
+        '--stats',
+        type=float,
+        nargs='?',
+        const=1.0,
+        metavar='SECONDS',
+        help='show RX/TX rates and command latency periodically, default interval: 1 s')
+
     args = parser.parse_args()
 
     if args.menu_char == args.exit_char:
@@ -1017,6 +1228,12 @@ def main(default_port=None, default_baudrate=9600, default_rts=None, default_dtr
     miniterm.raw = args.raw
     miniterm.set_rx_encoding(args.serial_port_encoding)
     miniterm.set_tx_encoding(args.serial_port_encoding)
+    prompt = args.prompt.encode('latin-1')
+    if args.binary:
+        miniterm.diverter = BinaryDiverter(args.binary, args.binary_dir, prompt)
+    if args.stats:
+        miniterm.stats = TrafficStats(prompt)
+        miniterm.stats_interval = args.stats
 
     if not args.quiet:
         sys.stderr.write('--- Miniterm on {p.name}  {p.baudrate},{p.bytesize},{p.parity},{p.stopbits} ---\n'.format(
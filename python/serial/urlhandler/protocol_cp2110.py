@@ -181,7 +181,7 @@ class Serial(SerialBase):
 
     @property
     def in_waiting(self):
-        return self._read_buffer.qsize()
+        return len(self._read_ahead) + self._read_buffer.qsize()
 
     def reset_input_buffer(self):
         if not self.is_open:
@@ -189,6 +189,7 @@ class Serial(SerialBase):
         self._hid_handle.send_feature_report(
             bytes((_REPORT_SET_PURGE_FIFOS, _PURGE_RX_FIFO)))
         # empty read buffer
+        del self._read_ahead[:]
         while self._read_buffer.qsize():
             self._read_buffer.get(False)
 
@@ -216,7 +217,7 @@ class Serial(SerialBase):
         if not self.is_open:
             raise PortNotOpenError()
 
-        data = bytearray()
+        data = self._take_read_ahead(size)
         try:
             timeout = Timeout(self._timeout)
             while len(data) < size:
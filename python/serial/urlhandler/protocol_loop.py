@@ -132,7 +132,7 @@ class Serial(SerialBase):
             # attention the logged value can differ from return value in
             # threaded environments...
             self.logger.debug('in_waiting -> {:d}'.format(self.queue.qsize()))
-        return self.queue.qsize()
+        return len(self._read_ahead) + self.queue.qsize()
 
     def read(self, size=1):
         """\
@@ -146,7 +146,8 @@ class Serial(SerialBase):
             timeout = time.time() + self._timeout
         else:
             timeout = None
-        data = bytearray()
+        data = self._take_read_ahead(size)
+        size -= len(data)
         while size > 0 and self.is_open:
             try:
                 b = self.queue.get(timeout=self._timeout)  # XXX inter char timeout
@@ -206,6 +207,7 @@ class Serial(SerialBase):
             raise PortNotOpenError()
         if self.logger:
             self.logger.info('reset_input_buffer()')
+        del self._read_ahead[:]
         try:
             while self.queue.qsize():
                 self.queue.get_nowait()
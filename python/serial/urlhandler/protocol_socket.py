@@ -28,8 +28,8 @@ try:
 except ImportError:
     import urllib.parse as urlparse
 
-from serial.serialutil import SerialBase, SerialException, to_bytes, \
-    PortNotOpenError, SerialTimeoutException, Timeout
+from serial.serialutil import SerialBase, SerialException, to_memoryview, \
+    advance_views, PortNotOpenError, SerialTimeoutException, Timeout
 
 # map log level names to constants. used in from_url()
 LOGGER_LEVELS = {
@@ -41,6 +41,12 @@ LOGGER_LEVELS = {
 
 POLL_TIMEOUT = 5
 
+# maximum number of buffers passed to a single sendmsg() call
+SENDMSG_MAX = 16
+
+# maximum number of bytes moved to read-ahead buffer by in_waiting
+RECV_CHUNK = 65536
+
 
 class Serial(SerialBase):
     """Serial port implementation for plain sockets."""
@@ -137,10 +143,22 @@ class Serial(SerialBase):
         """Return the number of bytes currently in the input buffer."""
         if not self.is_open:
             raise PortNotOpenError()
-        # Poll the socket to see if it is ready for reading.
-        # If ready, at least one byte will be to read.
-        lr, lw, lx = select.select([self._socket], [], [], 0)
-        return len(lr)
+        # Sockets do not tell how much is pending, so move what has arrived
+        # to the read-ahead buffer with a non-blocking recv. This way
+        # read_until() gets lines in chunks instead of byte by byte.
+        try:
+            data = self._socket.recv(RECV_CHUNK)
+        except OSError as e:
+            # ignore BlockingIOErrors and EINTR, nothing has arrived
+            if e.errno not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
+                raise SerialException('read failed: {}'.format(e))
+            data = None
+        if data == b'':
+            # EOF, count it as one byte so the next read() reports disconnect
+            return len(self._read_ahead) + 1
+        if data:
+            self._read_ahead.extend(data)
+        return len(self._read_ahead)
 
     # select based implementation, similar to posix, but only using socket API
     # to be portable, additionally handle socket timeout which is used to
@@ -153,7 +171,7 @@ class Serial(SerialBase):
         """
         if not self.is_open:
             raise PortNotOpenError()
-        read = bytearray()
+        read = self._take_read_ahead(size)
         timeout = Timeout(self._timeout)
         while len(read) < size:
             try:
@@ -186,64 +204,96 @@ class Serial(SerialBase):
                 break
         return bytes(read)
 
+    def readinto(self, b):
+        """\
+        Read up to len(b) bytes directly into the writable buffer b with
+        recv_into(), return the number of bytes read. Timeout handling is
+        the same as in read().
+        """
+        if not self.is_open:
+            raise PortNotOpenError()
+        view = memoryview(b).cast('B')
+        size = len(view)
+        read = self._take_read_ahead_into(view)
+        timeout = Timeout(self._timeout)
+        while read < size:
+            try:
+                ready, _, _ = select.select([self._socket], [], [], timeout.time_left())
+                if not ready:
+                    break   # timeout
+                n = self._socket.recv_into(view[read:])
+                # unless it is EOF, select reported some data
+                if not n:
+                    raise SerialException('socket disconnected')
+                read += n
+            except OSError as e:
+                # ignore BlockingIOErrors and EINTR. other errors are shown
+                if e.errno not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
+                    raise SerialException('read failed: {}'.format(e))
+            if timeout.expired():
+                break
+        return read
+
     def write(self, data):
         """\
         Output the given byte string over the serial port. Can block if the
         connection is blocked. May raise SerialException if the connection is
         closed.
         """
+        return self._write_views([to_memoryview(data)])
+
+    def writelines(self, lines):
+        """\
+        Output a sequence of byte strings, e.g. a header followed by a
+        payload, with one sendmsg() call where supported.
+        """
+        self._write_views([to_memoryview(line) for line in lines])
+
+    def _write_views(self, views):
+        """\
+        Send a list of byte memoryviews. Partial sends only advance the
+        views, and select() is used only when the socket buffer is full.
+        """
         if not self.is_open:
             raise PortNotOpenError()
-
-        d = to_bytes(data)
-        tx_len = length = len(d)
+        views = [view for view in views if len(view)]
+        written = 0
         timeout = Timeout(self._write_timeout)
-        while tx_len > 0:
+        while views:
             try:
-                n = self._socket.send(d)
-                if timeout.is_non_blocking:
-                    # Zero timeout indicates non-blocking - simply return the
-                    # number of bytes of data actually written
-                    return n
-                elif not timeout.is_infinite:
-                    # when timeout is set, use select to wait for being ready
-                    # with the time left as timeout
-                    if timeout.expired():
-                        raise SerialTimeoutException('Write timeout')
-                    _, ready, _ = select.select([], [self._socket], [], timeout.time_left())
-                    if not ready:
-                        raise SerialTimeoutException('Write timeout')
+                if hasattr(self._socket, 'sendmsg'):
+                    n = self._socket.sendmsg(views[:SENDMSG_MAX])
                 else:
-                    assert timeout.time_left() is None
-                    # wait for write operation
-                    _, ready, _ = select.select([], [self._socket], [], None)
-                    if not ready:
-                        raise SerialException('write failed (select)')
-                d = d[n:]
-                tx_len -= n
-            except SerialException:
-                raise
+                    n = self._socket.send(views[0])
             except OSError as e:
-                # this is for Python 3.x where select.error is a subclass of
-                # OSError ignore BlockingIOErrors and EINTR. other errors are shown
-                # https://www.python.org/dev/peps/pep-0475.
+                # ignore BlockingIOErrors and EINTR, wait below. other errors are shown
                 if e.errno not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
                     raise SerialException('write failed: {}'.format(e))
-            except select.error as e:
-                # this is for Python 2.x
-                # ignore BlockingIOErrors and EINTR. all errors are shown
-                # see also http://www.python.org/dev/peps/pep-3151/#select
-                if e[0] not in (errno.EAGAIN, errno.EALREADY, errno.EWOULDBLOCK, errno.EINPROGRESS, errno.EINTR):
-                    raise SerialException('write failed: {}'.format(e))
-            if not timeout.is_non_blocking and timeout.expired():
+                n = 0
+            written += n
+            if timeout.is_non_blocking:
+                # Zero timeout indicates non-blocking - simply return the
+                # number of bytes of data actually written
+                return written
+            advance_views(views, n)
+            if not views:
+                break
+            if timeout.expired():
+                raise SerialTimeoutException('Write timeout')
+            # wait until socket is ready for more, with the time left as timeout
+            _, ready, _ = select.select([], [self._socket], [], timeout.time_left())
+            if not ready:
+                if timeout.is_infinite:
+                    raise SerialException('write failed (select)')
                 raise SerialTimeoutException('Write timeout')
-        return length - len(d)
+        return written
 
     def reset_input_buffer(self):
         """Clear input buffer, discarding all that is in the buffer."""
         if not self.is_open:
             raise PortNotOpenError()
 
+        del self._read_ahead[:]
         # just use recv to remove input, while there is some
         ready = True
         while ready:
@@ -15,6 +15,7 @@
 # - dev=X   a file or device to write to
 # - color   use escape code to colorize output
 # - raw     forward raw bytes instead of hexdump
+# - rate=N  dump at most N bytes per second, count the rest (not with raw)
 #
 # example:
 #   redirect output to an other terminal window on Posix (Linux):
@@ -26,7 +27,7 @@ import sys
 import time
 
 import serial
-from serial.serialutil import  to_bytes
+from serial.serialutil import  SerialBase, to_bytes
 
 try:
     import urlparse
@@ -34,43 +35,24 @@ except ImportError:
     import urllib.parse as urlparse
 
 
-def sixteen(data):
-    """\
-    yield tuples of hex and ASCII display in multiples of 16. Includes a
-    space after 8 bytes and (None, None) after 16 bytes and at the end.
-    """
-    n = 0
-    for b in serial.iterbytes(data):
-        yield ('{:02X} '.format(ord(b)), b.decode('ascii') if b' ' <= b < b'\x7f' else '.')
-        n += 1
-        if n == 8:
-            yield (' ', '')
-        elif n >= 16:
-            yield (None, None)
-            n = 0
-    if n > 0:
-        while n < 16:
-            n += 1
-            if n == 8:
-                yield (' ', '')
-            yield ('   ', ' ')
-        yield (None, None)
+# replace everything except printable ASCII by '.' for the text column of hexdumps
+ASCII_TABLE = bytes(bytearray(c if 0x20 <= c < 0x7f else 0x2e for c in range(256)))
 
 
 def hexdump(data):
-    """yield lines with hexdump of data"""
-    values = []
-    ascii = []
-    offset = 0
-    for h, a in sixteen(data):
-        if h is None:
-            yield (offset, ' '.join([''.join(values), ''.join(ascii)]))
-            del values[:]
-            del ascii[:]
-            offset += 0x10
-        else:
-            values.append(h)
-            ascii.append(a)
+    """\
+    yield lines with hexdump of data, 16 bytes per line with a space after
+    8 bytes. Hex and ASCII columns are formatted for all data at once and
+    sliced into fixed width lines.
+    """
+    data = to_bytes(data)
+    values = data.hex(' ').upper() + ' '
+    ascii = data.translate(ASCII_TABLE).decode('ascii')
+    for offset in range(0, len(data), 16):
+        row = values[offset * 3:offset * 3 + 48]
+        if len(row) >= 24:
+            row = row[:24] + ' ' + row[24:]
+        yield (offset, ' '.join([row.ljust(49), ascii[offset:offset + 16].ljust(16)]))
 
 
 class FormatRaw(object):
@@ -100,6 +82,10 @@ class FormatRaw(object):
         """(do not) show control calls"""
         pass
 
+    def close(self):
+        """nothing is held back"""
+        pass
+
 
 class FormatHexdump(object):
     """\
@@ -114,36 +100,72 @@ class FormatHexdump(object):
         000003.001 TX   48 45 4C 4C 4F                                    HELLO
         000003.102 RX   48 45 4C 4C 4F                                    HELLO
 
+    With a rate limit set, only that many bytes per second are dumped and
+    the number of skipped bytes is shown once dumping resumes or the port
+    is closed, so logging a bulk transfer does not slow it down.
     """
 
-    def __init__(self, output, color):
+    def __init__(self, output, color, rate=None):
         self.start_time = time.time()
         self.output = output
         self.color = color
         self.rx_color = '\x1b[32m'
         self.tx_color = '\x1b[31m'
         self.control_color = '\x1b[37m'
+        self.rate = rate
+        self._allowance = rate
+        self._allowance_time = self.start_time
+        self._skipped = 0
+        self._skipped_label = None
 
     def write_line(self, timestamp, label, value, value2=''):
         self.output.write('{:010.3f} {:4} {}{}\n'.format(timestamp, label, value, value2))
         self.output.flush()
 
+    def write_dump(self, label, data, color):
+        """write hexdump of data at once, limited to the allowed rate"""
+        now = time.time()
+        skipped = 0
+        if self.rate is not None:
+            self._allowance = min(self.rate, self._allowance + (now - self._allowance_time) * self.rate)
+            self._allowance_time = now
+            allowed = min(len(data), int(self._allowance))
+            self._allowance -= allowed
+            skipped = len(data) - allowed
+            if not allowed:
+                self._skip(label, skipped)
+                return
+            data = data[:allowed]
+        timestamp = now - self.start_time
+        lines = ['{:010.3f} {:4} {:04X}  {}\n'.format(timestamp, label, offset, row)
+                 for offset, row in hexdump(data)]
+        if self._skipped:
+            lines.insert(0, '{:010.3f} {:4} <{} bytes skipped>\n'.format(timestamp, self._skipped_label, self._skipped))
+            self._skipped = 0
+        # the rest of this data is reported with the next dump
+        self._skip(label, skipped)
+        if self.color:
+            lines.insert(0, color)
+        self.output.write(''.join(lines))
+        self.output.flush()
+
+    def _skip(self, label, count):
+        if count:
+            self._skipped += count
+            self._skipped_label = label
+
     def rx(self, data):
         """show received data as hex dump"""
-        if self.color:
-            self.output.write(self.rx_color)
         if data:
-            for offset, row in hexdump(data):
-                self.write_line(time.time() - self.start_time, 'RX', '{:04X}  '.format(offset), row)
+            self.write_dump('RX', data, self.rx_color)
         else:
+            if self.color:
+                self.output.write(self.rx_color)
             self.write_line(time.time() - self.start_time, 'RX', '<empty>')
 
     def tx(self, data):
         """show transmitted data as hex dump"""
-        if self.color:
-            self.output.write(self.tx_color)
-        for offset, row in hexdump(data):
-            self.write_line(time.time() - self.start_time, 'TX', '{:04X}  '.format(offset), row)
+        self.write_dump('TX', data, self.tx_color)
 
     def control(self, name, value):
         """show control calls"""
@@ -151,6 +173,14 @@ class FormatHexdump(object):
             self.output.write(self.control_color)
         self.write_line(time.time() - self.start_time, name, value)
 
+    def close(self):
+        """show count of bytes that were skipped after the last dump"""
+        if self._skipped:
+            if self.color:
+                self.output.write(self.control_color)
+            self.write_line(time.time() - self.start_time, self._skipped_label, '<{} bytes skipped>'.format(self._skipped))
+            self._skipped = 0
+
 
 class Serial(serial.Serial):
     """\
@@ -179,6 +209,7 @@ class Serial(serial.Serial):
                 'not starting with spy:// ({!r})'.format(parts.scheme))
         # process options now, directly altering self
         formatter = FormatHexdump
+        rate = None
         color = False
         output = sys.stderr
         try:
@@ -191,26 +222,54 @@ class Serial(serial.Serial):
                     formatter = FormatRaw
                 elif option == 'all':
                     self.show_all = True
+                elif option == 'rate':
+                    rate = int(values[0])
+                    if rate <= 0:
+                        raise ValueError('rate must be positive: {!r}'.format(rate))
                 else:
                     raise ValueError('unknown option: {!r}'.format(option))
         except ValueError as e:
             raise serial.SerialException(
                 'expected a string in the form '
                 '"spy://port[?option[=value][&option[=value]]]": {}'.format(e))
-        self.formatter = formatter(output, color)
+        if formatter is FormatHexdump:
+            self.formatter = formatter(output, color, rate)
+        elif rate is not None:
+            raise serial.SerialException('rate limit is not supported with raw output')
+        else:
+            self.formatter = formatter(output, color)
         return ''.join([parts.netloc, parts.path])
 
+    def close(self):
+        if self.formatter is not None:
+            self.formatter.close()
+        super(Serial, self).close()
+
     def write(self, tx):
         tx = to_bytes(tx)
         self.formatter.tx(tx)
         return super(Serial, self).write(tx)
 
+    def writelines(self, lines):
+        lines = [to_bytes(line) for line in lines]
+        for tx in lines:
+            self.formatter.tx(tx)
+        super(Serial, self).writelines(lines)
+
     def read(self, size=1):
         rx = super(Serial, self).read(size)
         if rx or self.show_all:
             self.formatter.rx(rx)
         return rx
 
+    def readinto(self, b):
+        n = super(Serial, self).readinto(b)
+        if serial.Serial.readinto is SerialBase.readinto:
+            return n    # fallback went through read() above, data is shown already
+        if n or self.show_all:
+            self.formatter.rx(memoryview(b).cast('B')[:n])
+        return n
+
     if hasattr(serial.Serial, 'cancel_read'):
         def cancel_read(self):
             self.formatter.control('Q-RX', 'cancel_read')
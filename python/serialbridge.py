@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Bridges a local analyzer to TCP, use socket://<host>:<port> as device name to connect to it
+
+import argparse
+import os
+import select
+import socket
+import threading
+import time
+
+import serial
+from serial.tools import list_ports
+
+from remotecontrol import SMTVirtualCOMPort
+
+
+_DEFAULT_PORT = 7000
+_DEFAULT_BUFFER_SIZE = 1024 * 1024
+
+
+def _find_device() -> str:
+    for port in list_ports.comports():
+        if port.vid == SMTVirtualCOMPort.VID and port.pid in (SMTVirtualCOMPort.PID_GENERIC, SMTVirtualCOMPort.PID_TINYGTC):
+            return port.device
+
+    raise OSError('No devices found')
+
+
+def _format_rate(count: int, seconds: float) -> str:
+    rate = count / seconds if seconds > 0 else 0.0
+    return f'{count} bytes, {rate / 1024:.1f} KiB/s'
+
+
+class TransferStats:
+    def __init__(self):
+        self.start = time.monotonic()
+        self.device_to_network = 0
+        self.network_to_device = 0
+        self.peak_device_to_network = 0.0
+        self._lock = threading.Lock()
+        self._last_time = self.start
+        self._last_count = 0
+
+    def add_device_to_network(self, count: int):
+        with self._lock:
+            self.device_to_network += count
+
+    def add_network_to_device(self, count: int):
+        with self._lock:
+            self.network_to_device += count
+
+    def report(self) -> str:
+        with self._lock:
+            now = time.monotonic()
+            interval = now - self._last_time
+
+            if interval > 0:
+                rate = (self.device_to_network - self._last_count) / interval
+                self.peak_device_to_network = max(self.peak_device_to_network, rate)
+
+            self._last_time = now
+            self._last_count = self.device_to_network
+
+            elapsed = now - self.start
+            return f'{elapsed:.1f} s, device to network: {_format_rate(self.device_to_network, elapsed)}' \
+                f' (peak {self.peak_device_to_network / 1024:.1f} KiB/s),' \
+                f' network to device: {_format_rate(self.network_to_device, elapsed)}'
+
+
+class SerialBridge:
+    def __init__(self, device: serial.SerialBase, buffer_size: int = _DEFAULT_BUFFER_SIZE, verbose: bool = False):
+        self.device = device
+        self.buffer_size = buffer_size
+        self.verbose = verbose
+        self.stats_interval = 0.0
+
+        # Device to network data can bypass user space on Linux
+        self._splice = hasattr(os, 'splice') and hasattr(device, 'fd')
+
+    def serve(self, host: str, port: int):
+        server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        server.bind((host, port))
+        server.listen(1)
+
+        print(f'Bridging {self.device.name} to {host}:{port}...')
+
+        try:
+            while True:
+                client, address = server.accept()
+                print(f'Connected {address[0]}:{address[1]}')
+
+                try:
+                    stats = self._handle(client)
+                except OSError as ex:
+                    stats = None
+                    print(f'Connection failed, {ex}')
+                finally:
+                    client.close()
+
+                print(f'Disconnected {address[0]}:{address[1]}')
+
+                if stats:
+                    print(stats.report())
+        finally:
+            server.close()
+
+    def _handle(self, client: socket.socket) -> TransferStats:
+        # Commands and their echoes are tiny, send them immediately
+        client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        # capture and sd_read responses are bulk transfers
+        client.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, self.buffer_size)
+        client.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, self.buffer_size)
+
+        device = self.device
+        device.reset_input_buffer()
+
+        stats = TransferStats()
+        stop = threading.Event()
+
+        reader = threading.Thread(target=self._device_to_network, args=(client, stats, stop), daemon=True)
+        reader.start()
+
+        if self.stats_interval > 0:
+            threading.Thread(target=self._report, args=(stats, stop), daemon=True).start()
+
+        try:
+            self._network_to_device(client, stats, stop)
+        finally:
+            stop.set()
+            reader.join()
+
+        return stats
+
+    def _network_to_device(self, client: socket.socket, stats: TransferStats, stop: threading.Event):
+        buffer = bytearray(self.buffer_size)
+        view = memoryview(buffer)
+
+        while not stop.is_set():
+            ready, _, _ = select.select([client], [], [], 0.2)
+
+            if not ready:
+                continue
+
+            count = client.recv_into(view)
+
+            if not count:
+                break  # client disconnected
+
+            self.device.write(view[:count])
+            stats.add_network_to_device(count)
+
+    def _device_to_network(self, client: socket.socket, stats: TransferStats, stop: threading.Event):
+        try:
+            if self._splice:
+                try:
+                    self._splice_device_to_network(client, stats, stop)
+                    return
+                except OSError as ex:
+                    if stats.device_to_network:
+                        raise
+
+                    # Not supported for this device or socket, copy via user space then
+                    self._splice = False
+
+                    if self.verbose:
+                        print(f'Cannot splice from {self.device.name}, {ex}')
+
+            self._copy_device_to_network(client, stats, stop)
+        except (OSError, serial.SerialException) as ex:
+            if not stop.is_set():
+                print(f'Transfer failed, {ex}')
+        finally:
+            stop.set()
+
+            try:
+                client.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+
+    def _copy_device_to_network(self, client: socket.socket, stats: TransferStats, stop: threading.Event):
+        device = self.device
+        device.timeout = 0.2
+
+        buffer = bytearray(self.buffer_size)
+        view = memoryview(buffer)
+
+        while not stop.is_set():
+            # Receive whatever is waiting, but at least one byte
+            size = min(max(1, device.in_waiting), self.buffer_size)
+            count = device.readinto(view[:size])
+
+            if count:
+                client.sendall(view[:count])
+                stats.add_device_to_network(count)
+
+    def _splice_device_to_network(self, client: socket.socket, stats: TransferStats, stop: threading.Event):
+        device_fd = self.device.fd
+        client_fd = client.fileno()
+        pipe_read, pipe_write = os.pipe()
+
+        try:
+            while not stop.is_set():
+                ready, _, _ = select.select([device_fd], [], [], 0.2)
+
+                if not ready:
+                    continue
+
+                count = os.splice(device_fd, pipe_write, self.buffer_size)
+
+                if not count:
+                    raise serial.SerialException('device disconnected')
+
+                remaining = count
+
+                while remaining:
+                    remaining -= os.splice(pipe_read, client_fd, remaining)
+
+                stats.add_device_to_network(count)
+        finally:
+            os.close(pipe_read)
+            os.close(pipe_write)
+
+    def _report(self, stats: TransferStats, stop: threading.Event):
+        while not stop.wait(self.stats_interval):
+            print(stats.report())
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--device', help='specify device explicitly', metavar='device-name')
+    parser.add_argument('--host', default='', help='address to listen on, all interfaces by default')
+    parser.add_argument('--port', type=int, default=_DEFAULT_PORT, help=f'TCP port to listen on, {_DEFAULT_PORT} by default')
+    parser.add_argument('--buffer-size', type=int, default=_DEFAULT_BUFFER_SIZE, metavar='bytes',
+                        help='size of socket and transfer buffers')
+    parser.add_argument('--stats', type=float, default=0.0, metavar='seconds',
+                        help='report transfer statistics periodically')
+    parser.add_argument('--verbose', action='store_true', help='enable verbose output')
+    args = parser.parse_args()
+
+    device_name = args.device or _find_device()
+    device = serial.serial_for_url(device_name)
+
+    bridge = SerialBridge(device, args.buffer_size, args.verbose)
+    bridge.stats_interval = args.stats
+
+    try:
+        bridge.serve(args.host, args.port)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        device.close()
+
+
+if '__main__' == __name__:
+    main()
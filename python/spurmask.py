@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Predicts frequencies of internal spurs and images of tinySA ULTRA from preset settings
+#
+# This is a model of superheterodyne receiver, not a copy of firmware's spur tables:
+#   - local oscillator is a linear function of displayed frequency, LO = a * f + b, which depends on mode,
+#     below IF setting and harmonic used for mixing
+#   - internal spur appears when a product of LO and IF harmonics falls into IF, n * LO - m * IF = ±IF
+#   - in modes with harmonic mixing and mirror masking off, a signal also appears at its image, 2 * IF away
+# Device removes internal spurs itself when spur removal is on, so nothing is predicted in that case.
+
+import argparse
+import bisect
+
+import tinysa4preset
+from tinysa4preset import Enums
+
+
+_MAX_ORDER = 5
+
+
+class SpurModel:
+    def __init__(self, preset: tinysa4preset.Preset, max_order: int = _MAX_ORDER):
+        self.frequency_if = preset.frequency_if
+        self.mode = preset.mode
+        self.harmonic = max(preset.harmonic, 1)
+        self.below_if = preset.below_if in (Enums.S_ON, Enums.S_AUTO_ON)
+        self.mirror_masking = preset.mirror_masking
+        self.spur_removal = preset.spur_removal in (Enums.S_ON, Enums.S_AUTO_ON)
+        self.max_order = max_order
+
+        self._axis = None  # frequencies of the last mask
+        self._width = None
+        self._mask = None
+
+    def lo_coefficients(self) -> tuple:
+        """Return a and b of LO = a * f + b"""
+        frequency_if = self.frequency_if
+
+        if self.mode == Enums.M_LOW:
+            return (-1.0, frequency_if) if self.below_if else (1.0, frequency_if)
+
+        harmonic = self.harmonic if self.mode == Enums.M_ULTRA else 1
+        return 1.0 / harmonic, -frequency_if / harmonic
+
+    def spurs(self, start: float, stop: float) -> list:
+        """Return sorted displayed frequencies of internal spurs in given range"""
+        if self.spur_removal:
+            return []
+
+        a, b = self.lo_coefficients()
+        frequency_if = self.frequency_if
+        result = set()
+
+        for n in range(1, self.max_order + 1):
+            for m in range(0, self.max_order + 1):
+                for sign in (-1, 1):
+                    frequency = ((m + sign) * frequency_if / n - b) / a
+
+                    if start <= frequency <= stop:
+                        result.add(round(frequency))
+
+        return sorted(result)
+
+    def images(self, frequency: float) -> list:
+        """Return displayed frequencies where signal of given frequency appears besides itself"""
+        if self.mode == Enums.M_LOW or self.mirror_masking:
+            return []  # filtered by input low-pass filter, or masked by device
+
+        offset = 2 * self.frequency_if
+        return [frequency - offset, frequency + offset]
+
+    def mask(self, frequencies: list, width: float = None) -> list:
+        """Return list of flags for sweep points affected by internal spurs, built again only when axis changes"""
+        if frequencies != self._axis or width != self._width:
+            self._axis = frequencies
+            self._width = width
+            self._mask = self._build_mask(frequencies, width)
+
+        return self._mask
+
+    def _build_mask(self, frequencies: list, width: float) -> list:
+        count = len(frequencies)
+        mask = [False] * count
+
+        if count > 1:
+            step = (frequencies[-1] - frequencies[0]) / (count - 1)
+            width = width or 2 * step
+
+            for spur in self.spurs(frequencies[0] - width, frequencies[-1] + width):
+                first = bisect.bisect_left(frequencies, spur - width)
+                last = bisect.bisect_right(frequencies, spur + width)
+                mask[first:last] = [True] * (last - first)
+
+        return mask
+
+    def filter(self, frequencies: list, peaks: list) -> list:
+        """Drop peaks at internal spurs and images of stronger peaks, peaks are pairs of frequency and level"""
+        if len(frequencies) < 2:
+            return peaks
+
+        mask = self.mask(frequencies)
+        width = 2 * (frequencies[-1] - frequencies[0]) / (len(frequencies) - 1)
+        result = []
+
+        for frequency, level in sorted(peaks, key=lambda peak: peak[1], reverse=True):
+            index = min(bisect.bisect_left(frequencies, frequency), len(frequencies) - 1)
+
+            if mask[index] or self._is_image(frequency, result, width):
+                continue
+
+            result.append((frequency, level))
+
+        result.sort()
+        return result
+
+    def _is_image(self, frequency: float, stronger: list, width: float) -> bool:
+        return any(abs(image - frequency) <= width for signal, _ in stronger for image in self.images(signal))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('preset', metavar='prs-or-json-file', help='preset to take settings from')
+    parser.add_argument('--start', type=int, help='start frequency, taken from preset by default')
+    parser.add_argument('--stop', type=int, help='stop frequency, taken from preset by default')
+    args = parser.parse_args()
+
+    preset = tinysa4preset.load(args.preset)
+    model = SpurModel(preset)
+
+    start = preset.frequency0 if args.start is None else args.start
+    stop = preset.frequency1 if args.stop is None else args.stop
+
+    if model.spur_removal:
+        print('Spur removal is on, no internal spurs are expected')
+
+    for frequency in model.spurs(start, stop):
+        print(frequency)
+
+
+if '__main__' == __name__:
+    main()
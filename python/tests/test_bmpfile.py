@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks that compressed paletted bitmaps decode back to the same pixels
+
+import os
+import struct
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+from bmpfile import BMPFile
+
+
+_CAPTURE = os.path.join(os.path.dirname(__file__), '..', '..', 'data', 'capture.bmp')
+
+
+def _decode(path: str) -> list:
+    """Return colors of all pixels from top to bottom, decoded from RLE4 or RLE8 bitmap"""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    offset, = struct.unpack_from('<I', data, 10)
+    width, height, _, bpp, compression, size, _, _, colors = struct.unpack_from('<2i2H5I', data, 18)
+    assert compression == (BMPFile.BI_RLE4 if bpp == 4 else BMPFile.BI_RLE8)
+
+    palette = [struct.unpack_from('3B', data, 54 + index * 4)[::-1] for index in range(colors)]
+    rle, position, rows, row = data[offset:offset + size], 0, [], []
+
+    while True:
+        count, value = rle[position], rle[position + 1]
+        position += 2
+
+        if count:
+            nibbles = (value >> 4, value & 15) if bpp == 4 else (value, value)
+            row += [nibbles[index % 2] for index in range(count)]
+        elif value == 0:
+            rows.append(row)
+            row = []
+        elif value == 1:
+            break
+        else:
+            length = (value + 1) // 2 if bpp == 4 else value
+            chunk = rle[position:position + length]
+            position += length + length % 2
+
+            if bpp == 4:
+                chunk = [nibble for byte in chunk for nibble in (byte >> 4, byte & 15)]
+
+            row += chunk[:value]
+
+    assert len(rows) == height and all(len(row) == width for row in rows)
+    return [palette[index] for row in reversed(rows) for index in row]
+
+
+def _check_rle(directory: str, bitmap: BMPFile, bpp: int):
+    path = os.path.join(directory, f'rle{bpp}.bmp')
+    bitmap.save(path)
+
+    with open(path, 'rb') as f:
+        assert f.read()[28] == bpp
+
+    rows = [bitmap.pixels[offset:offset + bitmap.width] for offset in range(0, len(bitmap.pixels), bitmap.width)]
+
+    if bitmap.height > 0:
+        rows.reverse()  # stored from bottom to top
+
+    assert _decode(path) == [bitmap._rgb(pixel) for row in rows for pixel in row]
+
+
+def test_rle(directory: str):
+    _check_rle(directory, BMPFile(_CAPTURE), 4)
+
+    # Runs longer than 255 pixels, short literals, and odd literals of 4-bit pixels
+    pixels = [0] * 597 + [0xf800, 0x07e0, 0x001f] + [index % 5 for index in range(1799)] + [7]
+    synthetic = struct.pack('<2400H', *pixels)
+    _check_rle(directory, BMPFile.from_rgb565(600, 4, synthetic), 4)
+
+    # More than 16 colors
+    synthetic = synthetic[:-400] + struct.pack('<200H', *range(200))
+    _check_rle(directory, BMPFile.from_rgb565(600, 4, synthetic), 8)
+
+
+def main():
+    with tempfile.TemporaryDirectory() as directory:
+        test_rle(directory)
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks round trip of capture file, and rebuild of index after crash that left a shorter frame over longer ones
+
+import os
+import struct
+import sys
+import tempfile
+import zlib
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+from capturefile import CaptureFile
+
+
+_RAW = os.path.join(os.path.dirname(__file__), '..', '..', 'data', 'capture.raw')
+
+
+def test_round_trip(path: str, pixels: bytes):
+    with CaptureFile(path, 480, 320, compress=True) as capture:
+        for index in range(3):
+            capture.append(pixels, 1000.0 + index)
+
+    with CaptureFile(path) as capture:
+        assert len(capture) == 3
+        assert all(bytes(capture.pixels(index)) == pixels for index in range(3))
+
+
+def test_rebuild(path: str, pixels: bytes):
+    with CaptureFile(path) as capture:
+        first = capture.frames[0]
+
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    short = zlib.compress(pixels[:1000])
+    crashed = data[:first.offset + first.size] + struct.pack('<d2I', 2000.0, 1, len(short)) + short
+
+    with open(path, 'wb') as f:
+        f.write(crashed + data[len(crashed):-1])  # without footer
+
+    with CaptureFile(path) as capture:
+        assert [frame.timestamp for frame in capture.frames] == [1000.0, 2000.0]
+        assert bytes(capture.pixels(1)) == pixels[:1000]
+
+    with CaptureFile(path) as capture:
+        assert len(capture) == 2  # from rebuilt index
+
+
+def main():
+    with open(_RAW, 'rb') as f:
+        pixels = f.read()
+
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, 'test.cap')
+        test_round_trip(path, pixels)
+        test_rebuild(path, pixels)
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks that fixtures removed from synthetic cascades give back original S-parameters
+
+import cmath
+import os
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+import deembed
+
+
+_SCRIPT = os.path.join(os.path.dirname(__file__), '..', 'deembed.py')
+
+# Lossy line with some mismatch, and DUT that is not symmetric
+_FREQUENCIES = [1e6 * (index + 1) for index in range(101)]
+_FIXTURE = tuple([value * cmath.exp(-1j * frequency / 2e7) for frequency in _FREQUENCIES]
+                 for value in (0.1, 0.9, 0.9, 0.05))
+_DUT = tuple([value * cmath.exp(-1j * frequency / 5e7) for frequency in _FREQUENCIES]
+             for value in (0.3, 0.5, 0.4, 0.2))
+
+
+def _is_close(result, expected) -> bool:
+    return all(abs(a - b) < 1e-6 for values, other in zip(result, expected) for a, b in zip(values, other))
+
+
+def _deembed(directory: str, measured, *options) -> tuple:
+    measured_path = os.path.join(directory, 'measured.s2p')
+    output_path = os.path.join(directory, 'output.s2p')
+
+    deembed.write_touchstone(measured_path, _FREQUENCIES, measured)
+    subprocess.run([sys.executable, _SCRIPT, measured_path, output_path, *options], check=True)
+
+    _, result, names = deembed.read_touchstone(output_path)
+    return result, names
+
+
+def test_fixtures(directory: str, fixture_path: str):
+    # Fixture cascaded with itself, left one is removed
+    cascade = deembed.multiply(deembed.s_to_t(*_FIXTURE), deembed.s_to_t(*_FIXTURE))
+    result, names = _deembed(directory, deembed.t_to_s(*cascade), '--left', fixture_path)
+    assert names == ('S11', 'S21', 'S12', 'S22')
+    assert _is_close(result, _FIXTURE)
+
+    # DUT between fixtures, both are removed
+    cascade = deembed.multiply(deembed.multiply(deembed.s_to_t(*_FIXTURE), deembed.s_to_t(*_DUT)),
+                               deembed.s_to_t(*_FIXTURE))
+    result, _ = _deembed(directory, deembed.t_to_s(*cascade), '--left', fixture_path, '--right', fixture_path)
+    assert _is_close(result, _DUT)
+
+
+def test_transmission(directory: str, fixture_path: str):
+    # S21 only, as saved from one-path device, is divided by fixture transmission
+    result, names = _deembed(directory, [[a * b for a, b in zip(_DUT[1], _FIXTURE[1])]], '--left', fixture_path)
+    assert names == ('S21',) and len(result) == 1
+    assert _is_close(result, _DUT[1:2])
+
+
+def test_malformed(directory: str):
+    path = os.path.join(directory, 'malformed.s2p')
+    deembed.write_touchstone(path, _FREQUENCIES, _DUT)
+
+    # Incomplete last point
+    with open(path, 'a') as f:
+        f.write('102000000 0.1 0.2 0.3\n')
+
+    try:
+        deembed.read_touchstone(path)
+        assert False, 'malformed file was read'
+    except RuntimeError:
+        pass
+
+
+def test_axis_cache(fixture_path: str):
+    fixture = deembed.Fixture(fixture_path)
+    prepared = fixture.prepare(_FREQUENCIES)
+
+    # Equal axis reuses interpolated fixture
+    assert fixture.prepare(list(_FREQUENCIES)) is prepared
+
+    # Axis with the same ends and length is interpolated again
+    other = _FREQUENCIES[:50] + [_FREQUENCIES[50] + 5e5] + _FREQUENCIES[51:]
+    assert fixture.prepare(other) is not prepared
+    assert fixture.prepare(other) == deembed.Fixture(fixture_path).prepare(other)
+
+    # Only the last axis is kept
+    again = fixture.prepare(_FREQUENCIES)
+    assert again is not prepared and again == prepared
+
+
+def main():
+    with tempfile.TemporaryDirectory() as directory:
+        fixture_path = os.path.join(directory, 'fixture.s2p')
+        deembed.write_touchstone(fixture_path, _FREQUENCIES, _FIXTURE)
+
+        test_fixtures(directory, fixture_path)
+        test_transmission(directory, fixture_path)
+        test_malformed(directory)
+        test_axis_cache(fixture_path)
+
+
+if '__main__' == __name__:
+    main()
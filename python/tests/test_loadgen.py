@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks generated sweeps, alone and through detector and tracker
+
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+import loadgen
+import pipeline
+
+
+_LOADGEN = os.path.join(os.path.dirname(__file__), '..', 'loadgen.py')
+
+
+def test_noise():
+    generator = loadgen.SpectrumGenerator([(1000000, 100000000, 1000)], seed=1)
+    first, second = generator.sweep(0.0), generator.sweep(0.1)
+
+    # Points of different sweeps are unrelated
+    assert abs(statistics.correlation(first, second)) < 0.1
+
+    # Sweeps are not parts of one sequence, so neighbor levels rarely repeat, even when all sweeps are longer than noise table
+    pairs = []
+
+    for timestamp in range(100):
+        levels = generator.sweep(timestamp)
+        pairs += zip(levels, levels[1:])
+
+    assert len(set(pairs)) > 0.9 * len(pairs)
+    assert abs(statistics.mean(first) + 100.0) < 0.5
+
+
+def test_viewer_csv():
+    path = os.path.join(tempfile.mkdtemp(), 'load.csv')
+    generator = loadgen.SpectrumGenerator([(1000000, 100000000, 5000)], carriers=[loadgen.Carrier(50e6, -30)], seed=1)
+    loadgen.write_viewer_csv(path, generator, 3, 0.1)
+
+    # One line per point, one level per sweep, carrier is at the highest level
+    rows = [line.split(',') for line in open(path).read().splitlines()]
+    assert len(rows) == 5000 and all(len(levels.split()) == 3 for _, levels in rows)
+    peak = max(rows, key=lambda row: float(row[1].split()[0]))
+    assert abs(int(peak[0]) - 50e6) <= 20000
+
+
+def test_tracker():
+    directory = tempfile.mkdtemp()
+    archive = os.path.join(directory, 'load.swp')
+    tracks = os.path.join(directory, 'tracks.csv')
+    subprocess.run([sys.executable, _LOADGEN, '--band', '1000000', '100000000', '1000', '--carrier', '50e6:-30',
+                    '--count', '20', '--seed', '1', archive], check=True)
+
+    # Carrier wider than one point gives one track at its frequency
+    stages = [pipeline.ArchiveSource(archive), pipeline.ThresholdDetector(-60),
+              pipeline.PeakTracker(gate=500000, path=tracks)]
+    pipeline.Pipeline(stages).run()
+    assert stages[0].metrics.items_out == 20
+
+    lines = open(tracks).read().splitlines()
+    assert len(lines) == 2, lines
+    assert abs(float(lines[1].split(',')[5]) - 50e6) <= 100000
+
+
+def main():
+    test_noise()
+    test_viewer_csv()
+    test_tracker()
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks synchronized acquisition with simulated devices of different latencies
+
+import os
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+from multisweep import Channel, SynchronizedAcquisition
+from remotecontrol import SweepCSVSink
+
+
+class SimulatedDevice:
+    def __init__(self, delay: float):
+        self.delay = delay  # of every command
+        self.failures = 0  # number of scans to fail
+
+    def send(self, command: str):
+        pass
+
+    def receive(self) -> str:
+        time.sleep(self.delay)
+        return ''
+
+    def scan(self, start: int, stop: int, points: int) -> tuple:
+        time.sleep(self.delay)
+
+        if self.failures:
+            self.failures -= 1
+            raise RuntimeError('scan failed')
+
+        step = (stop - start) // (points - 1)
+        return [start + index * step for index in range(points)], [-90.0] * points
+
+
+def _acquisition(directory: str) -> SynchronizedAcquisition:
+    channels = [Channel(str(index), SimulatedDevice(delay), (1000000, 2000000, 11),
+                        SweepCSVSink(os.path.join(directory, f'multi_{index}.csv')))
+                for index, delay in enumerate((0.01, 0.03))]
+    return SynchronizedAcquisition(channels)
+
+
+def test_frames():
+    directory = tempfile.mkdtemp()
+    acquisition = _acquisition(directory)
+    acquisition.calibrate(3)
+
+    first, second = acquisition.channels
+    assert 0.005 <= first.latency < second.latency
+
+    acquisition.run(3)
+    assert acquisition.frames == 3
+
+    # The same frame is on the same line of both files
+    files = [open(channel.sink.path).read().splitlines() for channel in acquisition.channels]
+    assert all(len(lines) == 4 for lines in files)
+
+    for line0, line1 in zip(files[0][1:], files[1][1:]):
+        assert abs(float(line0.split(',')[0]) - float(line1.split(',')[0])) <= acquisition.max_skew + 1e-3
+
+
+def test_failure():
+    acquisition = _acquisition(tempfile.mkdtemp())
+    device = acquisition.channels[1].device
+    device.failures = 1
+
+    # The cause is raised, not the broken barrier of other channel
+    try:
+        acquisition.acquire()
+        assert False, 'failed scan was not reported'
+    except RuntimeError as ex:
+        assert str(ex) == 'scan failed'
+
+    # Failure doesn't affect next frames
+    acquisition.acquire()
+    acquisition.acquire()
+    assert acquisition.frames == 2
+
+
+def main():
+    test_frames()
+    test_failure()
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks that stage which fails stops whole pipeline, and its error is raised
+
+import os
+import sys
+import tempfile
+import threading
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+import pipeline
+
+
+class FailingStage(pipeline.Stage):
+    def __init__(self, failing_call: int):
+        super().__init__('failing')
+        self.failing_call = failing_call
+        self.count = 0
+
+    def process(self, sweep: pipeline.Sweep) -> list:
+        self.count += 1
+
+        if self.count == self.failing_call:
+            raise ValueError('broken')
+
+        return [sweep]
+
+
+def test_failure(directory: str):
+    path = os.path.join(directory, 'sweeps.csv')
+
+    with open(path, 'w') as f:
+        f.write('time,' + ','.join(str(100 + index) for index in range(10)) + '\n')
+
+        for index in range(1000):
+            f.write(f'{index},' + ','.join('-90.0' for _ in range(10)) + '\n')
+
+    stages = [pipeline.CSVReplaySource(path), pipeline.AccumulateTransform(1), FailingStage(3),
+              pipeline.CSVSink(path + '.out')]
+    errors = []
+
+    def run():
+        try:
+            pipeline.Pipeline(stages, queue_size=1, batch_size=1).run()
+        except RuntimeError as ex:
+            errors.append(ex)
+
+    thread = threading.Thread(target=run, daemon=True)
+    thread.start()
+    thread.join(10)
+
+    assert not thread.is_alive(), 'pipeline did not exit'
+    assert errors and isinstance(errors[0].__cause__, ValueError), errors
+
+
+def main():
+    with tempfile.TemporaryDirectory() as directory:
+        test_failure(directory)
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks segmentation of screen text in data directory, and reading of learned glyphs
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+import readout
+from bmpfile import BMPFile
+
+
+_CAPTURE = os.path.join(os.path.dirname(__file__), '..', '..', 'data', 'capture.bmp')
+
+
+def test_lines(screen: readout.Screen):
+    markers = list(readout._lines(screen, readout.DEFAULT_REGIONS['markers']))
+    settings = list(readout._lines(screen, readout.DEFAULT_REGIONS['settings']))
+
+    assert len(markers) == 1 and len(markers[0]) == 37
+    assert [len(glyphs) for glyphs in settings] == [3, 3, 6, 3, 5, 4, 4, 6, 4, 6, 5, 5, 5, 6, 7, 5, 6, 5]
+    assert all(len(glyph.rows) == 7 for glyphs in settings for glyph in glyphs)
+
+
+def test_font(screen: readout.Screen):
+    # Glyphs learned from RBW lines are found in VBW lines, unknown V is not guessed
+    font = readout.Font()
+    font.learn(screen, (0, 95, 30, 16), 'RBW:|850kHz')
+    assert font.read(screen, (0, 95, 30, 40)) == ['RBW:', '850kHz', '?BW:', '850kHz']
+
+
+def main():
+    screen = readout.Screen.from_bmp(BMPFile(_CAPTURE))
+
+    test_lines(screen)
+    test_font(screen)
+
+
+if '__main__' == __name__:
+    main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2025-2026 Alexey Lysiuk
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+# Checks spurs predicted from preset in data directory, and their removal from peaks
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..'))
+
+import spurmask
+import tinysa4preset
+
+
+_PRESET = os.path.join(os.path.dirname(__file__), '..', '..', 'data', 'startup.prs')
+
+
+def _model(spur_removal: bool = False) -> spurmask.SpurModel:
+    model = spurmask.SpurModel(tinysa4preset.load(_PRESET))
+    model.spur_removal = spur_removal
+    return model
+
+
+def test_spurs():
+    preset = tinysa4preset.load(_PRESET)
+    model = spurmask.SpurModel(preset)
+    assert model.spur_removal and not model.spurs(preset.frequency0, preset.frequency1)
+
+    # Harmonic of LO at every predicted spur is IF away from harmonic of IF
+    model.spur_removal = False
+    a, b = model.lo_coefficients()
+    spurs = model.spurs(preset.frequency0, preset.frequency1)
+    assert spurs
+
+    for spur in spurs:
+        lo = a * spur + b
+        assert any(abs(abs(n * lo - m * model.frequency_if) - model.frequency_if) <= n
+                   for n in range(1, 6) for m in range(6)), spur
+
+
+def test_filter():
+    model = _model()
+    spur = model.spurs(5000000, 800000000)[0]
+    frequencies = list(range(5000000, 800000001, 1000000))
+    assert model.filter(frequencies, [(spur, -40.0), (100000000, -50.0)]) == [(100000000, -50.0)]
+
+
+def test_mask_cache():
+    model = _model()
+    frequencies = list(range(5000000, 800000001, 1000000))
+    mask = model.mask(frequencies)
+    assert model.mask(list(frequencies)) is mask
+
+    # Axis with the same ends and length, and different width, are masked again
+    shifted = frequencies[:1] + [frequency + 500000 for frequency in frequencies[1:-1]] + frequencies[-1:]
+    assert model.mask(shifted) == _model().mask(shifted)
+    assert model.mask(frequencies, 5000000) == _model().mask(frequencies, 5000000) != mask
+
+
+def main():
+    test_spurs()
+    test_filter()
+    test_mask_cache()
+
+
+if '__main__' == __name__:
+    main()
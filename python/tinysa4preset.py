@@ -524,6 +524,19 @@ class _Formats:
     UINT_TRACES = f'<{Preset.TRACES_MAX}I'
 
 
+def load(path: str) -> Preset:
+    preset = Preset()
+
+    if path.lower().endswith('.prs'):
+        with open(path, 'rb') as f:
+            preset.from_binary(f)
+    else:
+        with open(path, encoding=_TEXT_ENCODING) as f:
+            preset.from_json(f)
+
+    return preset
+
+
 def convert(path: str):
     preset = Preset()
 